@@ -12,21 +12,291 @@
  *
  ****************************************/
 
+// Log site file ID, see board_log.h
+#define BOARD_LOG_FILE_ID		0
+
 #include <board_display.h>
-#include <ti/mw/display/Display.h>
+#include <board_load.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/UART.h>
+
+#include "Board.h"
+
+// Run time log level
+uint8_t boardDisplayLevel = BOARD_DISPLAY_LEVEL;
+
+// UART Interface, owned directly so binary frames can share the port
+static UART_Handle uartHandle = NULL;
+
+// Text line buffer
+static char lineBuf[BOARD_DISPLAY_LINE_LEN];
+
+// Transmit ring, the UART sends [txTail, txTail + txBusy) in the background
+static uint8_t txRing[BOARD_DISPLAY_TX_RING];
+static volatile uint16_t txHead = 0;
+static volatile uint16_t txTail = 0;
+static volatile uint16_t txBusy = 0;
+
+// Lines and frames lost to a full ring
+static uint32_t txDrops = 0;
 
-#define NULL 0
+// Receive frame parser states
+typedef enum {
+	RX_STATE_SOF,
+	RX_STATE_TYPE,
+	RX_STATE_LEN,
+	RX_STATE_DATA,
+	RX_STATE_CHECK
+} rxState_t;
 
-// Display Interface
-Display_Handle dispHandle = NULL;
+// Received frame handler, NULL while receive is off
+static boardDisplayRxCB_t rxHandler = NULL;
+
+// Receive parser
+static uint8_t rxByte;
+static rxState_t rxState = RX_STATE_SOF;
+static uint8_t rxType;
+static uint8_t rxLen;
+static uint8_t rxCount;
+static uint8_t rxCheck;
+static uint8_t rxBuf[BOARD_DISPLAY_RX_MAX];
+
+static void Board_Display_readCB(UART_Handle handle, void *buf, size_t count);
+static void Board_Display_rxParse(uint8_t byte);
+static void Board_Display_writeCB(UART_Handle handle, void *buf, size_t count);
+static void Board_Display_txCopy(const uint8_t *pData, uint16_t len);
+static void Board_Display_txKick(void);
 
 void Board_Display_Init() {
-	dispHandle = Display_open(Display_Type_UART, NULL);
+	UART_Params uartParams;
+
+	UART_Params_init(&uartParams);
+	uartParams.baudRate = BOARD_DISPLAY_BAUD_RATE;
+	uartParams.writeDataMode = UART_DATA_BINARY;
+	uartParams.readDataMode = UART_DATA_BINARY;
+	uartParams.readEcho = UART_ECHO_OFF;
+	uartParams.readMode = UART_MODE_CALLBACK;
+	uartParams.readCallback = Board_Display_readCB;
+	uartParams.writeMode = UART_MODE_CALLBACK;
+	uartParams.writeCallback = Board_Display_writeCB;
+
+	uartHandle = UART_open(Board_UART0, &uartParams);
 	uout0("\fUART Display initialized");
 }
 
 void Board_Display_Print(uintptr_t fmt,
 	uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3, uintptr_t a4) {
-	
-	Display_doPut5(dispHandle, 0, 0, fmt, a0, a1, a2, a3, a4);
+	boardLoadMark_t mark;
+	uint32_t key;
+	int len;
+
+	if (uartHandle == NULL)
+	{
+		return;
+	}
+
+	// Leave room for the line end
+	len = System_snprintf(lineBuf, sizeof(lineBuf) - 2, (const char *) fmt,
+			a0, a1, a2, a3, a4);
+	if (len < 0)
+	{
+		return;
+	}
+	if (len > sizeof(lineBuf) - 3)
+	{
+		len = sizeof(lineBuf) - 3;
+	}
+
+	lineBuf[len++] = '\r';
+	lineBuf[len++] = '\n';
+
+	Board_Load_enter(BOARD_LOAD_SLOT_DISPLAY, &mark);
+	key = Hwi_disable();
+	if (Board_Display_TxFree() < len)
+	{
+		txDrops++;
+		Hwi_restore(key);
+		Board_Load_exit(&mark);
+		return;
+	}
+	Board_Display_txCopy((uint8_t *) lineBuf, len);
+	Hwi_restore(key);
+
+	Board_Display_txKick();
+	Board_Load_exit(&mark);
+}
+
+void Board_Display_Frame(uint8_t type, const uint8_t *pData, uint8_t len) {
+	boardLoadMark_t mark;
+	uint8_t hdr[3];
+	uint8_t check;
+	uint32_t key;
+	uint8_t i;
+
+	if (uartHandle == NULL || len > BOARD_DISPLAY_FRAME_MAX)
+	{
+		return;
+	}
+
+	hdr[0] = BOARD_DISPLAY_FRAME_SOF;
+	hdr[1] = type;
+	hdr[2] = len;
+
+	check = type ^ len;
+	for (i = 0; i < len; i++)
+	{
+		check ^= pData[i];
+	}
+
+	// The frame goes in whole or not at all
+	Board_Load_enter(BOARD_LOAD_SLOT_DISPLAY, &mark);
+	key = Hwi_disable();
+	if (Board_Display_TxFree() < sizeof(hdr) + len + 1)
+	{
+		txDrops++;
+		Hwi_restore(key);
+		Board_Load_exit(&mark);
+		return;
+	}
+	Board_Display_txCopy(hdr, sizeof(hdr));
+	Board_Display_txCopy(pData, len);
+	Board_Display_txCopy(&check, 1);
+	Hwi_restore(key);
+
+	Board_Display_txKick();
+	Board_Load_exit(&mark);
+}
+
+uint16_t Board_Display_TxFree(void) {
+	return (BOARD_DISPLAY_TX_RING - 1)
+			- ((txHead - txTail) & (BOARD_DISPLAY_TX_RING - 1));
+}
+
+uint32_t Board_Display_TxDrops(void) {
+	return txDrops;
+}
+
+void Board_Display_SetLevel(uint8_t level) {
+	// Sites above the build level are not in the image
+	boardDisplayLevel = (level > BOARD_DISPLAY_LEVEL) ? BOARD_DISPLAY_LEVEL : level;
+}
+
+void Board_Display_RxStart(boardDisplayRxCB_t pfnFrame) {
+	if (uartHandle == NULL || rxHandler != NULL)
+	{
+		return;
+	}
+
+	rxHandler = pfnFrame;
+	rxState = RX_STATE_SOF;
+	UART_read(uartHandle, &rxByte, 1);
+}
+
+// One byte received, parse it and ask for the next one
+static void Board_Display_readCB(UART_Handle handle, void *buf, size_t count) {
+	if (count == 1)
+	{
+		Board_Display_rxParse(rxByte);
+	}
+
+	UART_read(handle, &rxByte, 1);
+}
+
+// Frame parser, same framing as Board_Display_Frame. A bad checksum or
+// an oversized frame drops the frame and resyncs on the next SOF.
+static void Board_Display_rxParse(uint8_t byte) {
+	switch (rxState)
+	{
+		case RX_STATE_SOF:
+			if (byte == BOARD_DISPLAY_FRAME_SOF)
+			{
+				rxState = RX_STATE_TYPE;
+			}
+			break;
+
+		case RX_STATE_TYPE:
+			rxType = byte;
+			rxCheck = byte;
+			rxState = RX_STATE_LEN;
+			break;
+
+		case RX_STATE_LEN:
+			rxLen = byte;
+			rxCheck ^= byte;
+			rxCount = 0;
+			if (rxLen > BOARD_DISPLAY_RX_MAX)
+			{
+				rxState = RX_STATE_SOF;
+			} else
+			{
+				rxState = rxLen ? RX_STATE_DATA : RX_STATE_CHECK;
+			}
+			break;
+
+		case RX_STATE_DATA:
+			rxBuf[rxCount++] = byte;
+			rxCheck ^= byte;
+			if (rxCount == rxLen)
+			{
+				rxState = RX_STATE_CHECK;
+			}
+			break;
+
+		case RX_STATE_CHECK:
+			if (byte == rxCheck && rxHandler != NULL)
+			{
+				rxHandler(rxType, rxBuf, rxLen);
+			}
+			rxState = RX_STATE_SOF;
+			break;
+
+		default:
+			rxState = RX_STATE_SOF;
+			break;
+	}
+}
+
+// Copy to the ring, space checked and interrupts disabled by the caller
+static void Board_Display_txCopy(const uint8_t *pData, uint16_t len) {
+	uint16_t head = txHead;
+	uint16_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		txRing[head] = pData[i];
+		head = (head + 1) & (BOARD_DISPLAY_TX_RING - 1);
+	}
+	txHead = head;
+}
+
+// Start sending the next contiguous run of the ring if the UART is idle
+static void Board_Display_txKick(void) {
+	uint32_t key = Hwi_disable();
+	uint16_t tail = txTail;
+	uint16_t head = txHead;
+	uint16_t len;
+
+	if (txBusy != 0 || head == tail || uartHandle == NULL)
+	{
+		Hwi_restore(key);
+		return;
+	}
+
+	len = (head > tail) ? (head - tail) : (BOARD_DISPLAY_TX_RING - tail);
+	txBusy = len;
+	Hwi_restore(key);
+
+	UART_write(uartHandle, &txRing[tail], len);
+}
+
+// A run was sent, free it and send the next one
+static void Board_Display_writeCB(UART_Handle handle, void *buf, size_t count) {
+	uint32_t key = Hwi_disable();
+
+	txTail = (txTail + txBusy) & (BOARD_DISPLAY_TX_RING - 1);
+	txBusy = 0;
+	Hwi_restore(key);
+
+	Board_Display_txKick();
 }
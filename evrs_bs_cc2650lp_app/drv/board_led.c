@@ -22,7 +22,7 @@
 
 #include "Board.h"
 
-#include "util.h"
+#include "board_timer.h"
 #include "board_led.h"
 
 /*********************************************************************
@@ -46,7 +46,7 @@ PIN_Config ledPinTable[] = {
  */
 
 /* flash control timer */
-static Clock_Struct ledFlashClk[2];
+static boardTimer_t ledFlashTmr[2];
 
 /* LED pin state */
 static PIN_State ledPinState;
@@ -85,11 +85,11 @@ void Board_initLEDs(void) {
 	ledState[BOARD_LED_ID_R] = BOARD_LED_STATE_OFF;
 	ledState[BOARD_LED_ID_R] = BOARD_LED_STATE_OFF;
 
-	/* construct clock to control the flashing */
-	Util_constructClock(&ledFlashClk[BOARD_LED_ID_R], Board_ledFlashTimeoutCB,
-	BOARD_LED_FLASH_PERIOD, 0, false, BOARD_LED_ID_R);
-	Util_constructClock(&ledFlashClk[BOARD_LED_ID_G], Board_ledFlashTimeoutCB,
-	BOARD_LED_FLASH_PERIOD, 0, false, BOARD_LED_ID_G);
+	/* construct timer to control the flashing, Board_Timer_init first */
+	Board_Timer_construct(&ledFlashTmr[BOARD_LED_ID_R], Board_ledFlashTimeoutCB,
+	BOARD_LED_FLASH_PERIOD, 0, BOARD_LED_ID_R);
+	Board_Timer_construct(&ledFlashTmr[BOARD_LED_ID_G], Board_ledFlashTimeoutCB,
+	BOARD_LED_FLASH_PERIOD, 0, BOARD_LED_ID_G);
 }
 
 /*****************************************************************************
@@ -109,19 +109,19 @@ void Board_ledControl(boardLedId_t ledId, boardLedState_t state,
 	{
 		case BOARD_LED_STATE_OFF:
 			PIN_setOutputValue(ledPinHandle, IDPARSER(ledId), 0);
-			if (ledState[ledId] == BOARD_LED_STATE_FLASH) Util_stopClock(
-					&ledFlashClk[ledId]);
+			if (ledState[ledId] == BOARD_LED_STATE_FLASH) Board_Timer_stop(
+					&ledFlashTmr[ledId]);
 			break;
 
 		case BOARD_LED_STATE_ON:
 			PIN_setOutputValue(ledPinHandle, IDPARSER(ledId), 1);
-			if (ledState[ledId] == BOARD_LED_STATE_FLASH) Util_stopClock(
-					&ledFlashClk[ledId]);
+			if (ledState[ledId] == BOARD_LED_STATE_FLASH) Board_Timer_stop(
+					&ledFlashTmr[ledId]);
 			break;
 
 		case BOARD_LED_STATE_FLASH:
 			PIN_setOutputValue(ledPinHandle, IDPARSER(ledId), 0);
-			Util_restartClock(&ledFlashClk[ledId], period);
+			Board_Timer_restart(&ledFlashTmr[ledId], period);
 			break;
 
 		default:
@@ -150,5 +150,5 @@ static void Board_ledFlashTimeoutCB(UArg ledId) {
 	PIN_setOutputValue(ledPinHandle, IDPARSER((boardLedId_t ) ledId),
 			!PIN_getOutputValue(IDPARSER((boardLedId_t ) ledId)));
 
-	Util_startClock(&ledFlashClk[ledId]);
+	Board_Timer_start(&ledFlashTmr[ledId]);
 }
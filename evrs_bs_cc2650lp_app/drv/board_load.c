@@ -0,0 +1,176 @@
+/*****************************************************************************
+
+ file	board_load.c
+
+ brief	This file contains the CPU load metering. Only the task that
+ called Board_Load_init is metered, so drivers shared with other tasks
+ can charge their slot unconditionally. Time outside every slot is idle
+ or other tasks.
+
+ proj	EVRS
+
+ date	1019pm 19 Oct 2026
+
+ author	Ziyi
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * Includes
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "board_load.h"
+
+/*********************************************************************
+ * Local Variables
+ */
+
+// Slot counters
+static boardLoadSlot_t loadSlots[BOARD_LOAD_MAX_SLOTS];
+
+// Metered task, NULL until initialised
+static Task_Handle loadTask = NULL;
+
+// Slot running and when it was last charged
+static uint8_t loadCur = BOARD_LOAD_SLOT_NONE;
+static uint32_t loadStamp;
+
+// Start of the current window
+static uint32_t loadWindow;
+
+/*********************************************************************
+ * Local Functions
+ */
+
+static void Board_Load_charge(uint32_t now);
+
+/*********************************************************************
+ * Public Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Load_init
+ *
+ * @brief   Start metering the calling task.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Load_init(void) {
+	memset(loadSlots, 0, sizeof(loadSlots));
+	loadCur = BOARD_LOAD_SLOT_NONE;
+	loadWindow = Clock_getTicks();
+	loadTask = Task_self();
+}
+
+/*****************************************************************************
+ * @fn      Board_Load_enter
+ *
+ * @brief   Charge time to a slot until the matching Board_Load_exit.
+ *
+ * @param   slot - slot
+ pMark - entry mark
+ *
+ * @return  none
+ */
+void Board_Load_enter(uint8_t slot, boardLoadMark_t *pMark) {
+	uint32_t now;
+
+	pMark->slot = BOARD_LOAD_SLOT_NONE;
+	if (loadTask == NULL || Task_self() != loadTask
+			|| slot >= BOARD_LOAD_MAX_SLOTS)
+	{
+		return;
+	}
+
+	now = Clock_getTicks();
+	Board_Load_charge(now);
+
+	pMark->slot = slot;
+	pMark->prev = loadCur;
+	pMark->start = now;
+	loadCur = slot;
+	if (loadSlots[slot].calls != 0xFFFF)
+	{
+		loadSlots[slot].calls++;
+	}
+}
+
+/*****************************************************************************
+ * @fn      Board_Load_exit
+ *
+ * @brief   Go back to the slot running before the matching entry.
+ *
+ * @param   pMark - entry mark
+ *
+ * @return  none
+ */
+void Board_Load_exit(const boardLoadMark_t *pMark) {
+	uint32_t now;
+
+	// Entry was made from another task or not metered
+	if (pMark->slot == BOARD_LOAD_SLOT_NONE)
+	{
+		return;
+	}
+
+	now = Clock_getTicks();
+	Board_Load_charge(now);
+
+	if (now - pMark->start > loadSlots[pMark->slot].maxCall)
+	{
+		loadSlots[pMark->slot].maxCall = now - pMark->start;
+	}
+	loadCur = pMark->prev;
+}
+
+/*****************************************************************************
+ * @fn      Board_Load_collect
+ *
+ * @brief   Copy and clear the slot counters.
+ *
+ * @param   pSlots - destination
+ *
+ * @return  window length in RTOS clock ticks
+ */
+uint32_t Board_Load_collect(boardLoadSlot_t *pSlots) {
+	uint32_t now = Clock_getTicks();
+	uint32_t window;
+
+	// Bring a slot still running up to date before the copy
+	Board_Load_charge(now);
+
+	memcpy(pSlots, loadSlots, sizeof(loadSlots));
+	memset(loadSlots, 0, sizeof(loadSlots));
+
+	window = now - loadWindow;
+	loadWindow = now;
+
+	return window;
+}
+
+/*********************************************************************
+ * Local Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Load_charge
+ *
+ * @brief   Charge the time since the last charge to the running slot.
+ *
+ * @param   now - current time
+ *
+ * @return  none
+ */
+static void Board_Load_charge(uint32_t now) {
+	if (loadCur != BOARD_LOAD_SLOT_NONE)
+	{
+		loadSlots[loadCur].busy += now - loadStamp;
+	}
+	loadStamp = now;
+}
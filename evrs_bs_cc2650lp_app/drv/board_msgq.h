@@ -0,0 +1,126 @@
+/*****************************************************************************
+
+file	board_msgq.h
+
+brief	This file contains the application message lane definitions and
+		prototypes. Each lane is an RTOS queue with its own depth limit,
+		service budget and latency counters.
+
+proj	EVRS
+
+date	1019pm 19 Oct 2026
+
+author	Ziyi
+
+*****************************************************************************/
+
+#ifndef BOARD_MSGQ_H
+#define BOARD_MSGQ_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/sysbios/knl/Queue.h>
+
+#include "icall.h"
+
+/*****************************************************************************
+ * Typedefs
+ */
+
+/** Lane counters, latencies in RTOS clock ticks **/
+typedef struct
+{
+    uint32_t count;			// messages serviced
+    uint32_t totalLatency;	// sum of enqueue to service latencies
+    uint32_t maxLatency;	// longest enqueue to service latency
+    uint32_t drops;			// messages refused by a full lane
+    uint16_t depth;			// messages queued now
+    uint16_t highWater;		// deepest the lane has been
+} boardMsgLaneStats_t;
+
+/** Message lane **/
+typedef struct
+{
+    Queue_Struct queue;
+    Queue_Handle handle;
+    uint16_t maxDepth;		// most messages queued, 0 for no limit
+    boardMsgLaneStats_t stats;
+} boardMsgLane_t;
+
+/** Message handler, the message is freed after it returns **/
+typedef void (*boardMsgHandler_t)(uint8_t *pMsg);
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_construct
+ *
+ * @brief   Set up an empty lane.
+ *
+ * @param   pLane - lane
+ 			maxDepth - most messages queued, 0 for no limit
+ *
+ * @return  none
+ */
+void Board_MsgQ_construct(boardMsgLane_t *pLane, uint16_t maxDepth);
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_enqueue
+ *
+ * @brief   Queue an ICall_malloc'd message and wake the owner task. Safe
+ 			from any task, SWI or HWI. A full lane refuses the message.
+ *
+ * @param   pLane - lane
+ 			sem - owner task semaphore
+ 			pMsg - message
+ *
+ * @return  true if queued, the caller keeps the message otherwise
+ */
+bool Board_MsgQ_enqueue(boardMsgLane_t *pLane, ICall_Semaphore sem,
+		uint8_t *pMsg);
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_service
+ *
+ * @brief   Hand queued messages to a handler in FIFO order and free them.
+ *
+ * @param   pLane - lane
+ 			pfnMsg - handler
+ 			budget - most messages to service, 0 for all
+ *
+ * @return  number of messages serviced
+ */
+uint8_t Board_MsgQ_service(boardMsgLane_t *pLane, boardMsgHandler_t pfnMsg,
+		uint8_t budget);
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_pending
+ *
+ * @brief   Check whether a lane holds messages.
+ *
+ * @param   pLane - lane
+ *
+ * @return  true if not empty
+ */
+bool Board_MsgQ_pending(boardMsgLane_t *pLane);
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_getStats
+ *
+ * @brief   Copy the lane counters.
+ *
+ * @param   pLane - lane
+ 			pStats - destination
+ *
+ * @return  none
+ */
+void Board_MsgQ_getStats(boardMsgLane_t *pLane, boardMsgLaneStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_MSGQ_H */
@@ -0,0 +1,442 @@
+/*****************************************************************************
+
+ file	board_timer.c
+
+ brief	This file contains the application timer wheel. Timers are kept in
+ a hashed wheel of BOARD_TIMER_NUM_SLOTS doubly linked lists indexed by
+ expiry tick, so start and stop are O(1). One one-shot RTOS clock is
+ armed for the nearest non-empty slot and only wakes the application
+ task, the callbacks run from Board_Timer_process.
+
+ The wheel is not locked, every Board_Timer_* call must come from the
+ task calling Board_Timer_process.
+
+ proj	EVRS
+
+ date	1019pm 19 Oct 2026
+
+ author	Ziyi
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * Includes
+ */
+
+#include <stddef.h>
+
+#include <ti/sysbios/knl/Clock.h>
+
+#include "util.h"
+#include "board_timer.h"
+
+/*********************************************************************
+ * Typedefs
+ */
+
+/* Slot index of the list holding timers due in this pass */
+#define BOARD_TIMER_SLOT_DUE	BOARD_TIMER_NUM_SLOTS
+
+/* Slot index of a stopped timer */
+#define BOARD_TIMER_SLOT_NONE	0xFF
+
+#define BOARD_TIMER_SLOT_MASK	(BOARD_TIMER_NUM_SLOTS - 1)
+
+/*********************************************************************
+ * Local Varibles
+ */
+
+/* slot lists, the extra list holds the timers due in this pass */
+static boardTimer_t *timerSlots[BOARD_TIMER_NUM_SLOTS + 1];
+
+/* wheel clock */
+static Clock_Struct timerClk;
+
+/* RTOS clock ticks per wheel tick */
+static uint32_t ticksPerWheel;
+
+/* RTOS clock tick of the current wheel tick boundary */
+static uint32_t clkBase;
+
+/* current wheel tick */
+static uint32_t wheelNow;
+
+/* last wheel tick walked by Board_Timer_process */
+static uint32_t wheelDone;
+
+/* wheel tick the clock is armed for */
+static uint32_t clkExpiry;
+static bool clkArmed = false;
+
+/* set while callbacks run, the clock is re-armed afterwards */
+static bool inProcess = false;
+
+/* task wakeup */
+static void (*timerWake)(void) = NULL;
+
+/*********************************************************************
+ * Local Functions
+ */
+static void Board_Timer_clockCB(UArg arg);
+static void Board_Timer_sync(void);
+static void Board_Timer_arm(uint32_t expiry);
+static void Board_Timer_rearm(void);
+static void Board_Timer_link(boardTimer_t *pTimer, uint8_t slot);
+static void Board_Timer_unlink(boardTimer_t *pTimer);
+static uint32_t Board_Timer_msToTicks(uint32_t ms);
+
+/*********************************************************************
+ * Public Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Timer_init
+ *
+ * @brief   Initial the timer wheel.
+ *
+ * @param   pfnWake - called from the clock SWI when timers are due
+ *
+ * @return  none
+ */
+void Board_Timer_init(void (*pfnWake)(void)) {
+	uint8_t i;
+
+	for (i = 0; i <= BOARD_TIMER_NUM_SLOTS; i++)
+	{
+		timerSlots[i] = NULL;
+	}
+
+	timerWake = pfnWake;
+
+	ticksPerWheel = (BOARD_TIMER_TICK_MS * 1000) / Clock_tickPeriod;
+	if (ticksPerWheel == 0)
+	{
+		ticksPerWheel = 1;
+	}
+
+	clkBase = Clock_getTicks();
+	wheelNow = 0;
+	wheelDone = 0;
+	clkArmed = false;
+
+	Util_constructClock(&timerClk, Board_Timer_clockCB,
+	BOARD_TIMER_TICK_MS, 0, false, 0);
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_construct
+ *
+ * @brief   Set up a timer, the timer is left stopped.
+ *
+ * @param   pTimer - timer object
+ pfnCB - callback
+ timeout - first expiry in ms
+ period - reload in ms, 0 for one-shot
+ arg - callback argument
+ *
+ * @return  none
+ */
+void Board_Timer_construct(boardTimer_t *pTimer, boardTimerCB_t pfnCB,
+		uint32_t timeout, uint32_t period, UArg arg) {
+	pTimer->pNext = NULL;
+	pTimer->pPrev = NULL;
+	pTimer->expiry = 0;
+	pTimer->timeout = Board_Timer_msToTicks(timeout);
+	pTimer->period = period ? Board_Timer_msToTicks(period) : 0;
+	pTimer->pfnCB = pfnCB;
+	pTimer->arg = arg;
+	pTimer->slot = BOARD_TIMER_SLOT_NONE;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_start
+ *
+ * @brief   Arm a timer with its current timeout, restarting it if armed.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  none
+ */
+void Board_Timer_start(boardTimer_t *pTimer) {
+	Board_Timer_unlink(pTimer);
+
+	Board_Timer_sync();
+	pTimer->expiry = wheelNow + pTimer->timeout;
+	Board_Timer_link(pTimer, pTimer->expiry & BOARD_TIMER_SLOT_MASK);
+
+	if (!inProcess
+			&& (!clkArmed || (int32_t) (pTimer->expiry - clkExpiry) < 0))
+	{
+		Board_Timer_arm(pTimer->expiry);
+	}
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_restart
+ *
+ * @brief   Arm a timer with a new timeout.
+ *
+ * @param   pTimer - timer object
+ timeout - expiry in ms
+ *
+ * @return  none
+ */
+void Board_Timer_restart(boardTimer_t *pTimer, uint32_t timeout) {
+	pTimer->timeout = Board_Timer_msToTicks(timeout);
+	Board_Timer_start(pTimer);
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_stop
+ *
+ * @brief   Disarm a timer. The wheel clock is left running, a wakeup with
+ nothing due only re-arms it.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  none
+ */
+void Board_Timer_stop(boardTimer_t *pTimer) {
+	Board_Timer_unlink(pTimer);
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_isActive
+ *
+ * @brief   Check whether a timer is armed.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  true if armed
+ */
+bool Board_Timer_isActive(boardTimer_t *pTimer) {
+	return (pTimer->slot != BOARD_TIMER_SLOT_NONE);
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_process
+ *
+ * @brief   Fire every due timer and re-arm the wheel clock.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Timer_process(void) {
+	boardTimer_t *pTimer;
+	boardTimer_t *pNext;
+	uint32_t tick;
+
+	Board_Timer_sync();
+
+	/* nothing can be due before the clock expires */
+	if (clkArmed && (int32_t) (wheelNow - clkExpiry) < 0)
+	{
+		return;
+	}
+
+	/* a full revolution visits every slot */
+	if (wheelNow - wheelDone > BOARD_TIMER_NUM_SLOTS)
+	{
+		wheelDone = wheelNow - BOARD_TIMER_NUM_SLOTS;
+	}
+
+	/* move the due timers of every slot passed to the due list */
+	for (tick = wheelDone + 1; tick != wheelNow + 1; tick++)
+	{
+		for (pTimer = timerSlots[tick & BOARD_TIMER_SLOT_MASK];
+				pTimer != NULL; pTimer = pNext)
+		{
+			pNext = pTimer->pNext;
+			if ((int32_t) (pTimer->expiry - wheelNow) <= 0)
+			{
+				Board_Timer_unlink(pTimer);
+				Board_Timer_link(pTimer, BOARD_TIMER_SLOT_DUE);
+			}
+		}
+	}
+	wheelDone = wheelNow;
+
+	/* fire them, a callback may start or stop any timer */
+	inProcess = true;
+	clkArmed = false;
+	while ((pTimer = timerSlots[BOARD_TIMER_SLOT_DUE]) != NULL)
+	{
+		Board_Timer_unlink(pTimer);
+
+		if (pTimer->period)
+		{
+			pTimer->expiry += pTimer->period;
+			if ((int32_t) (pTimer->expiry - wheelNow) <= 0)
+			{
+				pTimer->expiry = wheelNow + 1;
+			}
+			Board_Timer_link(pTimer, pTimer->expiry & BOARD_TIMER_SLOT_MASK);
+		}
+
+		pTimer->pfnCB(pTimer->arg);
+	}
+	inProcess = false;
+
+	Board_Timer_rearm();
+}
+
+/*********************************************************************
+ * Local Functions
+ */
+
+/*****************************************************************************
+ * @fn      Board_Timer_clockCB
+ *
+ * @brief   Wheel clock expiry, runs in SWI context.
+ *
+ * @param   arg - unused
+ *
+ * @return  none
+ */
+static void Board_Timer_clockCB(UArg arg) {
+	if (timerWake != NULL)
+	{
+		timerWake();
+	}
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_sync
+ *
+ * @brief   Advance the current wheel tick to the RTOS clock, safe across
+ RTOS tick counter wrap.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+static void Board_Timer_sync(void) {
+	uint32_t elapsed = (Clock_getTicks() - clkBase) / ticksPerWheel;
+
+	wheelNow += elapsed;
+	clkBase += elapsed * ticksPerWheel;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_arm
+ *
+ * @brief   Arm the wheel clock for a wheel tick after the current one.
+ *
+ * @param   expiry - wheel tick
+ *
+ * @return  none
+ */
+static void Board_Timer_arm(uint32_t expiry) {
+	uint32_t ticks = (expiry - wheelNow) * ticksPerWheel
+			- (Clock_getTicks() - clkBase);
+	Clock_Handle handle = Clock_handle(&timerClk);
+
+	if ((int32_t) ticks <= 0)
+	{
+		ticks = 1;
+	}
+
+	Clock_stop(handle);
+	Clock_setTimeout(handle, ticks);
+	Clock_start(handle);
+
+	clkExpiry = expiry;
+	clkArmed = true;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_rearm
+ *
+ * @brief   Arm the wheel clock for the nearest non-empty slot. A slot may
+ only hold timers of a later revolution, which costs one extra wakeup
+ per revolution for timers longer than the wheel span.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+static void Board_Timer_rearm(void) {
+	uint32_t tick;
+
+	for (tick = wheelNow + 1; tick != wheelNow + 1 + BOARD_TIMER_NUM_SLOTS;
+			tick++)
+	{
+		if (timerSlots[tick & BOARD_TIMER_SLOT_MASK] != NULL)
+		{
+			Board_Timer_arm(tick);
+			return;
+		}
+	}
+
+	Clock_stop(Clock_handle(&timerClk));
+	clkArmed = false;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_link
+ *
+ * @brief   Push a timer at the head of a slot list.
+ *
+ * @param   pTimer - timer object
+ slot - slot index
+ *
+ * @return  none
+ */
+static void Board_Timer_link(boardTimer_t *pTimer, uint8_t slot) {
+	pTimer->slot = slot;
+	pTimer->pPrev = NULL;
+	pTimer->pNext = timerSlots[slot];
+	if (pTimer->pNext != NULL)
+	{
+		pTimer->pNext->pPrev = pTimer;
+	}
+	timerSlots[slot] = pTimer;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_unlink
+ *
+ * @brief   Remove a timer from its slot list, if any.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  none
+ */
+static void Board_Timer_unlink(boardTimer_t *pTimer) {
+	if (pTimer->slot == BOARD_TIMER_SLOT_NONE)
+	{
+		return;
+	}
+
+	if (pTimer->pPrev != NULL)
+	{
+		pTimer->pPrev->pNext = pTimer->pNext;
+	}
+	else
+	{
+		timerSlots[pTimer->slot] = pTimer->pNext;
+	}
+	if (pTimer->pNext != NULL)
+	{
+		pTimer->pNext->pPrev = pTimer->pPrev;
+	}
+
+	pTimer->pNext = NULL;
+	pTimer->pPrev = NULL;
+	pTimer->slot = BOARD_TIMER_SLOT_NONE;
+}
+
+/*****************************************************************************
+ * @fn      Board_Timer_msToTicks
+ *
+ * @brief   Convert ms to wheel ticks, rounded up, at least one tick.
+ *
+ * @param   ms - duration in ms
+ *
+ * @return  wheel ticks
+ */
+static uint32_t Board_Timer_msToTicks(uint32_t ms) {
+	uint32_t ticks = (ms + BOARD_TIMER_TICK_MS - 1) / BOARD_TIMER_TICK_MS;
+
+	return ticks ? ticks : 1;
+}
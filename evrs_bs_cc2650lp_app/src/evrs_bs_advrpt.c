@@ -0,0 +1,308 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_advrpt.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		decoded advert report ring between the GAP central
+ * 				role callback and the application task
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include <ti/sysbios/knl/Clock.h>
+
+#include "evrs_bs_advrpt.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Report ring. The GAP central role task (priority 3) is the only
+// producer and the application task (priority 1) the only consumer,
+// so the consumer can never run in the middle of a push.
+static EbsAdvRec_t advRing[EBS_ADVRPT_RING_SIZE];
+static volatile uint8_t advHead = 0;	// next slot to write
+static volatile uint8_t advTail = 0;	// next slot to read
+
+// Ring counters
+static EbsAdvRptStats_t advStats;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static bool EBS_AdvRpt_merge(const EbsAdvRec_t *pRec);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_decode
+ *
+ * @brief   Decode an advert or scan response report in one pass over
+ *          its AD structures.
+ *
+ * @param   pInfo - device info event from the GAP central role
+ * @param   bsID - identifier of this base station
+ * @param   pRec - decoded record
+ *
+ * @return  TRUE if the report carries anything the app needs
+ */
+bool EBS_AdvRpt_decode(gapDeviceInfoEvent_t *pInfo, uint8_t bsID,
+		EbsAdvRec_t *pRec) {
+	uint8_t *pData = pInfo->pEvtData;
+	uint8_t *pEnd = pInfo->pEvtData + pInfo->dataLen;
+	bool svcFound = FALSE;
+	bool bsMatch = FALSE;
+
+	pRec->flags = 0;
+
+	// While a length and type byte remain
+	while (pData + 1 < pEnd)
+	{
+		uint8_t adLen = pData[0];
+		uint8_t *pVal = pData + 2;
+		uint8_t i;
+
+		// Zero length terminates the significant part, stop on truncation
+		if (adLen == 0 || pData + 1 + adLen > pEnd)
+		{
+			break;
+		}
+
+		switch (pData[1])
+		{
+			case GAP_ADTYPE_16BIT_MORE:
+			case GAP_ADTYPE_16BIT_COMPLETE:
+				for (i = 0; i + 2 < adLen; i += 2)
+				{
+					if ((pVal[i] == LO_UINT16(EVRSPROFILE_SERV_UUID))
+							&& (pVal[i + 1] == HI_UINT16(EVRSPROFILE_SERV_UUID)))
+					{
+						svcFound = TRUE;
+					}
+				}
+				break;
+
+			case ETX_ADTYPE_DEST:
+				bsMatch = (adLen >= 2) && (pVal[0] == bsID);
+				break;
+
+			case ETX_ADTYPE_DEVID:
+				if (adLen > ETX_DEVID_LEN)
+				{
+					memcpy(pRec->txDevID, pVal, ETX_DEVID_LEN);
+					pRec->flags |= EBS_ADV_FLAG_DEVID;
+				}
+				break;
+
+			case ETX_ADTYPE_DVER:
+				if (adLen >= 2)
+				{
+					pRec->dataVer = pVal[0];
+					pRec->flags |= EBS_ADV_FLAG_DVER;
+				}
+				break;
+
+			case GAP_ADTYPE_POWER_LEVEL:
+				if (adLen >= 2)
+				{
+					pRec->txPower = (int8_t) pVal[0];
+					pRec->flags |= EBS_ADV_FLAG_TXPWR;
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		// Go to next AD item
+		pData += 1 + adLen;
+	}
+
+	if (svcFound && bsMatch)
+	{
+		pRec->flags |= EBS_ADV_FLAG_TARGET;
+	}
+
+	if (pRec->flags == 0)
+	{
+		return FALSE;
+	}
+
+	memcpy(pRec->addr, pInfo->addr, B_ADDR_LEN);
+	pRec->addrType = pInfo->addrType;
+	pRec->rssi = pInfo->rssi;
+
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_push
+ *
+ * @brief   Append a decoded record to the ring, or fold it into a
+ *          queued record of the same kind from the same Tx. Called from
+ *          the GAP central role callback.
+ *
+ * @param   pRec - record to copy into the ring
+ *
+ * @return  TRUE if the ring was empty and the app task must be woken
+ */
+bool EBS_AdvRpt_push(const EbsAdvRec_t *pRec) {
+	uint8_t head = advHead;
+	uint8_t next = (head + 1) & (EBS_ADVRPT_RING_SIZE - 1);
+	bool wasEmpty = (head == advTail);
+
+	uint8_t depth;
+
+	advStats.reports++;
+
+	// A Tx repeating itself is the cheapest report to lose
+	if (EBS_AdvRpt_merge(pRec))
+	{
+		advStats.merges++;
+		return FALSE;
+	}
+
+	// Ring full, the app task already has a wakeup pending
+	if (next == advTail)
+	{
+		advStats.drops++;
+		return FALSE;
+	}
+
+	advRing[head] = *pRec;
+	advRing[head].stamp = Clock_getTicks();
+	advHead = next;
+
+	depth = (next - advTail) & (EBS_ADVRPT_RING_SIZE - 1);
+	if (depth > advStats.highWater)
+	{
+		advStats.highWater = depth;
+	}
+
+	if (wasEmpty)
+	{
+		advStats.signals++;
+	}
+
+	return wasEmpty;
+}
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_drain
+ *
+ * @brief   Hand queued records to the app in arrival order. Called from
+ *          the application task.
+ *
+ * @param   pfnRec - record handler
+ * @param   budget - most records to deliver, 0 for all
+ *
+ * @return  number of records delivered
+ */
+uint8_t EBS_AdvRpt_drain(void (*pfnRec)(EbsAdvRec_t *pRec),
+		uint8_t budget) {
+	uint8_t count = 0;
+
+	while (advTail != advHead && (budget == 0 || count < budget))
+	{
+		uint32_t latency = Clock_getTicks() - advRing[advTail].stamp;
+
+		advStats.totalLatency += latency;
+		if (latency > advStats.maxLatency)
+		{
+			advStats.maxLatency = latency;
+		}
+
+		pfnRec(&advRing[advTail]);
+		advTail = (advTail + 1) & (EBS_ADVRPT_RING_SIZE - 1);
+		count++;
+	}
+
+	if (count)
+	{
+		advStats.batches++;
+		if (count > advStats.maxBatch)
+		{
+			advStats.maxBatch = count;
+		}
+	}
+
+	return count;
+}
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_pending
+ *
+ * @brief   Check whether records are waiting for the app.
+ *
+ * @return  TRUE if the ring is not empty
+ */
+bool EBS_AdvRpt_pending(void) {
+	return (advTail != advHead);
+}
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_getStats
+ *
+ * @brief   Copy the ring counters.
+ *
+ * @param   pStats - destination
+ *
+ * @return  none
+ */
+void EBS_AdvRpt_getStats(EbsAdvRptStats_t *pStats) {
+	*pStats = advStats;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_AdvRpt_merge
+ *
+ * @brief   Overwrite a queued record of the same kind from the same
+ *          advertiser with a newer report. The record at the tail may
+ *          be in use by the app task and is never touched.
+ *
+ * @param   pRec - newer record
+ *
+ * @return  TRUE if the report was folded into a queued record
+ */
+static bool EBS_AdvRpt_merge(const EbsAdvRec_t *pRec) {
+	uint8_t head = advHead;
+	uint8_t idx = advTail;
+
+	if (idx == head)
+	{
+		return FALSE;
+	}
+
+	for (idx = (idx + 1) & (EBS_ADVRPT_RING_SIZE - 1); idx != head;
+			idx = (idx + 1) & (EBS_ADVRPT_RING_SIZE - 1))
+	{
+		EbsAdvRec_t *pQueued = &advRing[idx];
+
+		if (pQueued->flags == pRec->flags
+				&& pQueued->addrType == pRec->addrType
+				&& memcmp(pQueued->addr, pRec->addr, B_ADDR_LEN) == 0)
+		{
+			// Keep the original push time so latency stays honest
+			uint32_t stamp = pQueued->stamp;
+
+			*pQueued = *pRec;
+			pQueued->stamp = stamp;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,80 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_advrpt.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		decoded advert report ring between the GAP central
+ * 				role callback and the application task
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_ADVRPT_H_
+#define EVRS_BS_ADVRPT_H_
+
+#include "bcomdef.h"
+#include "gap.h"
+#include "evrs_bs_typedefs.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Number of decoded reports the ring can hold, must be a power of 2
+#ifndef EBS_ADVRPT_RING_SIZE
+#define EBS_ADVRPT_RING_SIZE		16
+#endif
+
+// Advert record flags
+#define EBS_ADV_FLAG_TARGET			0x01	// EVRS service aimed at this BS
+#define EBS_ADV_FLAG_DEVID			0x02	// Tx ID present in the report
+#define EBS_ADV_FLAG_DVER			0x04	// data version present in the report
+#define EBS_ADV_FLAG_TXPWR			0x08	// Tx output power present in the report
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Compact decoded advert or scan response report
+typedef struct {
+	uint8_t addr[B_ADDR_LEN];		// advertiser address
+	uint8_t addrType;				// advertiser address type
+	int8_t rssi;					// report RSSI in dBm
+	uint8_t flags;					// EBS_ADV_FLAG_*
+	uint8_t txDevID[ETX_DEVID_LEN];	// Tx ID, valid with EBS_ADV_FLAG_DEVID
+	uint8_t dataVer;				// data version, valid with EBS_ADV_FLAG_DVER
+	int8_t txPower;					// Tx output power in dBm, valid with EBS_ADV_FLAG_TXPWR
+	uint32_t stamp;					// push time in RTOS clock ticks
+} EbsAdvRec_t;
+
+// Ring counters, reports / signals gives the number of reports
+// delivered per application task wakeup
+typedef struct {
+	uint32_t reports;	// reports pushed by the role callback
+	uint32_t drops;		// reports lost to a full ring
+	uint32_t merges;	// reports folded into a queued one from the same Tx
+	uint32_t signals;	// app task wakeups requested
+	uint32_t batches;	// drains that delivered at least one report
+	uint8_t maxBatch;	// most reports delivered by one drain
+	uint8_t highWater;	// most reports queued at once
+	uint32_t totalLatency;	// sum of push to delivery latencies in ticks
+	uint32_t maxLatency;	// longest push to delivery latency in ticks
+} EbsAdvRptStats_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern bool EBS_AdvRpt_decode(gapDeviceInfoEvent_t *pInfo, uint8_t bsID,
+		EbsAdvRec_t *pRec);
+extern bool EBS_AdvRpt_push(const EbsAdvRec_t *pRec);
+extern uint8_t EBS_AdvRpt_drain(void (*pfnRec)(EbsAdvRec_t *pRec),
+		uint8_t budget);
+extern bool EBS_AdvRpt_pending(void);
+extern void EBS_AdvRpt_getStats(EbsAdvRptStats_t *pStats);
+
+#endif /* EVRS_BS_ADVRPT_H_ */
@@ -0,0 +1,187 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_bcast.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		Tx command broadcast, one non-connectable advertising
+ * 				burst reaches every Tx in range
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "board_timer.h"
+#include "evrs_bs_bcast.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Advertising data, a single ETX_ADTYPE_BCAST structure
+static uint8_t bcastData[ETX_BCAST_AD_LEN + 1] = {
+		ETX_BCAST_AD_LEN,
+		ETX_ADTYPE_BCAST
+};
+
+// Bumped on every new command, repeats of a burst share it
+static uint8_t bcastSeq = 0;
+
+// Entity the GAP calls are made for
+static uint8_t bcastTaskID;
+
+// Advertising, or asked to start
+static bool bcastOn = FALSE;
+
+// Ends the burst
+static boardTimer_t bcastTmr;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void EBS_Bcast_end(UArg a0);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Bcast_init
+ *
+ * @brief   Set up the burst, nothing goes out until EBS_Bcast_send.
+ *
+ * @param   taskID - entity registered for GAP messages
+ * @param   bsID - identifier of this base station
+ *
+ * @return  none
+ */
+void EBS_Bcast_init(uint8_t taskID, uint8_t bsID) {
+	bcastTaskID = taskID;
+	bcastData[2 + ETX_BCAST_BSID_IDX] = bsID;
+
+	// Only used by the broadcast, the central role does not advertise
+	GAP_SetParamValue(TGAP_GEN_DISC_ADV_INT_MIN, EBS_BCAST_ADV_INT);
+	GAP_SetParamValue(TGAP_GEN_DISC_ADV_INT_MAX, EBS_BCAST_ADV_INT);
+
+	Board_Timer_construct(&bcastTmr, EBS_Bcast_end, EBS_BCAST_BURST, 0, 0);
+}
+
+/*********************************************************************
+ * @fn      EBS_Bcast_send
+ *
+ * @brief   Broadcast a Tx command with the current epoch. A burst in
+ *          progress carries on with the new command and starts over.
+ *
+ * @param   epoch - question epoch
+ * @param   op - ETX_CMD_OP_*, the arg applies as if written to CMD
+ * @param   arg - command argument
+ *
+ * @return  FALSE if the stack cannot advertise. Either way nothing
+ *          tells which Tx heard the burst, the caller confirms the
+ *          command with each Tx.
+ */
+bool EBS_Bcast_send(uint8_t epoch, uint8_t op, uint8_t arg) {
+	bcastData[2 + ETX_BCAST_SEQ_IDX] = ++bcastSeq;
+	bcastData[2 + ETX_BCAST_EPOCH_IDX] = epoch;
+	bcastData[2 + ETX_BCAST_OP_IDX] = op;
+	bcastData[2 + ETX_BCAST_ARG_IDX] = arg;
+
+	if (GAP_UpdateAdvertisingData(bcastTaskID, TRUE, sizeof(bcastData),
+			bcastData) != SUCCESS)
+	{
+		return FALSE;
+	}
+
+	if (!bcastOn)
+	{
+		gapAdvertisingParams_t params;
+
+		memset(&params, 0, sizeof(params));
+		params.eventType = GAP_ADTYPE_ADV_NONCONN_IND;
+		params.initiatorAddrType = ADDRTYPE_PUBLIC;
+		params.channelMap = GAP_ADVCHAN_ALL;
+		params.filterPolicy = GAP_FILTER_POLICY_ALL;
+
+		if (GAP_MakeDiscoverable(bcastTaskID, &params) != SUCCESS)
+		{
+			return FALSE;
+		}
+		bcastOn = TRUE;
+	}
+
+	Board_Timer_stop(&bcastTmr);
+	Board_Timer_start(&bcastTmr);
+
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Bcast_processEvent
+ *
+ * @brief   Take the GAP events answering the broadcast calls.
+ *
+ * @param   pEvent - GAP_MAKE_DISCOVERABLE_DONE_EVENT,
+ *                   GAP_END_DISCOVERABLE_DONE_EVENT or
+ *                   GAP_ADV_DATA_UPDATE_DONE_EVENT
+ *
+ * @return  TRUE once the burst is over, sent or refused
+ */
+bool EBS_Bcast_processEvent(gapEventHdr_t *pEvent) {
+	switch (pEvent->opcode)
+	{
+		case GAP_MAKE_DISCOVERABLE_DONE_EVENT:
+			if (pEvent->hdr.status != SUCCESS)
+			{
+				// Refused by the controller, nothing went out
+				bcastOn = FALSE;
+				Board_Timer_stop(&bcastTmr);
+				return TRUE;
+			}
+			break;
+
+		case GAP_END_DISCOVERABLE_DONE_EVENT:
+			bcastOn = FALSE;
+			return TRUE;
+
+		default:
+			break;
+	}
+
+	return FALSE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Bcast_active
+ *
+ * @brief   Whether a burst is going out.
+ *
+ * @return  TRUE from EBS_Bcast_send until the burst is over
+ */
+bool EBS_Bcast_active(void) {
+	return bcastOn;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Bcast_end
+ *
+ * @brief   Burst timer handler, stop advertising.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_Bcast_end(UArg a0) {
+	if (bcastOn)
+	{
+		GAP_EndDiscoverable(bcastTaskID);
+	}
+}
@@ -0,0 +1,48 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_bcast.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		Tx command broadcast, one non-connectable advertising
+ * 				burst reaches every Tx in range
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_BCAST_H_
+#define EVRS_BS_BCAST_H_
+
+#include "bcomdef.h"
+#include "gap.h"
+#include "evrs_bs_typedefs.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Burst length in ms, longer than the Tx observe period so every Tx
+// gets a few chances to hear it
+#ifndef EBS_BCAST_BURST
+#define EBS_BCAST_BURST				4000
+#endif
+
+// Advertising interval during a burst, units of 625us, 160=100ms which
+// is the shortest allowed for non-connectable advertising
+#ifndef EBS_BCAST_ADV_INT
+#define EBS_BCAST_ADV_INT			160
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Bcast_init(uint8_t taskID, uint8_t bsID);
+extern bool EBS_Bcast_send(uint8_t epoch, uint8_t op, uint8_t arg);
+extern bool EBS_Bcast_processEvent(gapEventHdr_t *pEvent);
+extern bool EBS_Bcast_active(void);
+
+#endif /* EVRS_BS_BCAST_H_ */
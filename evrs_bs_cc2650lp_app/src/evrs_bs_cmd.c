@@ -0,0 +1,154 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_cmd.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		binary commands from the host over the UART
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "icall.h"
+#include "board_display.h"
+#include "evrs_bs_main.h"
+#include "evrs_bs_cmd.h"
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void EBS_Cmd_rxFrame(uint8_t type, const uint8_t *pData, uint8_t len);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Cmd_init
+ *
+ * @brief   Start receiving host commands. Call after Board_Display_Init.
+ *
+ * @return  none
+ */
+void EBS_Cmd_init(void) {
+	Board_Display_RxStart(EBS_Cmd_rxFrame);
+}
+
+/*********************************************************************
+ * @fn      EBS_Cmd_check
+ *
+ * @brief   Check the payload length of a command.
+ *
+ * @param   cmd - command
+ * @param   len - payload length
+ *
+ * @return  EBS_CMD_STATUS_OK, _UNKNOWN or _BAD_LEN
+ */
+uint8_t EBS_Cmd_check(uint8_t cmd, uint8_t len) {
+	bool lenOk;
+
+	switch (cmd)
+	{
+		case EBS_CMD_START_DISC:
+		case EBS_CMD_STOP_DISC:
+		case EBS_CMD_START_POLL:
+			lenOk = (len == 0);
+			break;
+
+		case EBS_CMD_LOAD_ROSTER:
+			lenOk = (len > 0) && (len % EBS_CMD_ROSTER_ENTRY_LEN == 0);
+			break;
+
+		case EBS_CMD_POLL:
+			lenOk = (len % ETX_DEVID_LEN == 0);
+			break;
+
+		case EBS_CMD_SET_SCAN:
+			lenOk = (len == 6);
+			break;
+
+		case EBS_CMD_SET_CONN:
+			lenOk = (len == 8);
+			break;
+
+		case EBS_CMD_QUERY:
+		case EBS_CMD_SET_LOG:
+		case EBS_CMD_SET_EPOCH:
+			lenOk = (len == 1);
+			break;
+
+		case EBS_CMD_SET_PERIOD:
+		case EBS_CMD_ACK:
+			lenOk = (len == 3);
+			break;
+
+		case EBS_CMD_BCAST:
+			lenOk = (len == ETX_CMD_LEN);
+			break;
+
+		default:
+			return EBS_CMD_STATUS_UNKNOWN;
+	}
+
+	return lenOk ? EBS_CMD_STATUS_OK : EBS_CMD_STATUS_BAD_LEN;
+}
+
+/*********************************************************************
+ * @fn      EBS_Cmd_respond
+ *
+ * @brief   Tell the host how a command went.
+ *
+ * @param   cmd - command
+ * @param   status - EBS_CMD_STATUS_*
+ *
+ * @return  none
+ */
+void EBS_Cmd_respond(uint8_t cmd, uint8_t status) {
+	uint8_t rsp[2];
+
+	rsp[0] = cmd;
+	rsp[1] = status;
+	Board_Display_Frame(EBS_FRAME_CMD_RSP, rsp, sizeof(rsp));
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Cmd_rxFrame
+ *
+ * @brief   Received frame handler, runs in the UART callback. Copies the
+ *          frame as [type, len, payload] and queues it for the app task.
+ *          A frame that cannot be queued is lost and shows up in the
+ *          lane drop counters.
+ *
+ * @param   type - frame type
+ * @param   pData - payload
+ * @param   len - payload length
+ *
+ * @return  none
+ */
+static void EBS_Cmd_rxFrame(uint8_t type, const uint8_t *pData, uint8_t len) {
+	uint8_t *pCmd = ICall_malloc(len + 2);
+
+	if (pCmd == NULL)
+	{
+		return;
+	}
+
+	pCmd[0] = type;
+	pCmd[1] = len;
+	memcpy(&pCmd[2], pData, len);
+
+	if (!EBS_enqueueMsg(EBS_HOST_CMD_EVT, 0, pCmd))
+	{
+		ICall_free(pCmd);
+	}
+}
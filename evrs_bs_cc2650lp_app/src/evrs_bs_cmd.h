@@ -0,0 +1,60 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_cmd.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		binary commands from the host over the UART
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_CMD_H_
+#define EVRS_BS_CMD_H_
+
+#include "bcomdef.h"
+#include "evrs_bs_typedefs.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Host commands, sent with the uplink framing, the type is the command.
+// Multi-byte fields are little endian.
+#define EBS_CMD_START_DISC			0x40	// []
+#define EBS_CMD_STOP_DISC			0x41	// []
+#define EBS_CMD_START_POLL			0x42	// []
+#define EBS_CMD_LOAD_ROSTER			0x43	// [addrType, addr[6], txDevID[4]] * n
+#define EBS_CMD_POLL				0x44	// [txDevID[4]] * n, none for every Tx
+#define EBS_CMD_SET_SCAN			0x45	// [interval, window, duration ms]
+#define EBS_CMD_SET_CONN			0x46	// [min int, max int, latency, timeout]
+#define EBS_CMD_QUERY				0x47	// [frame type]
+#define EBS_CMD_SET_PERIOD			0x48	// [frame type, period ms], 0 stops
+#define EBS_CMD_ACK					0x49	// [next vote seq, credit], no response
+#define EBS_CMD_SET_LOG				0x4A	// [log level], BOARD_DISPLAY_LVL_*
+#define EBS_CMD_SET_EPOCH			0x4B	// [epoch], starts a new question
+#define EBS_CMD_BCAST				0x4C	// [Tx opcode, arg] to every Tx at once
+
+// Length of one EBS_CMD_LOAD_ROSTER entry
+#define EBS_CMD_ROSTER_ENTRY_LEN	(1 + B_ADDR_LEN + ETX_DEVID_LEN)
+
+// Command status, second byte of EBS_FRAME_CMD_RSP
+#define EBS_CMD_STATUS_OK			0x00
+#define EBS_CMD_STATUS_UNKNOWN		0x01	// no such command
+#define EBS_CMD_STATUS_BAD_LEN		0x02	// payload length wrong
+#define EBS_CMD_STATUS_BAD_STATE	0x03	// not valid in the current state
+#define EBS_CMD_STATUS_BAD_ARG		0x04	// argument out of range or unknown Tx
+#define EBS_CMD_STATUS_FULL			0x05	// roster full
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Cmd_init(void);
+extern uint8_t EBS_Cmd_check(uint8_t cmd, uint8_t len);
+extern void EBS_Cmd_respond(uint8_t cmd, uint8_t status);
+
+#endif /* EVRS_BS_CMD_H_ */
@@ -0,0 +1,237 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_conn.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		per-connection contexts indexed by connection handle
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "evrs_bs_conn.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Connection contexts. The controller hands out connection handles
+// 0 .. MAX_NUM_BLE_CONNS - 1, so a handle is also the table index.
+EbsConnCtx_t connCtx[MAX_NUM_BLE_CONNS];
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Tx of the link being established, at most one at a time
+static TargetInfo_t connPending;
+static bool connPendingValid = FALSE;
+
+// Number of contexts in use
+static uint8_t numActive = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void EBS_Conn_reset(EbsConnCtx_t *pCtx);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Conn_init
+ *
+ * @brief   Free every context and construct the per-link timers.
+ *
+ * @param   pfnDisc - service discovery timer handler, called with the
+ *                    connection handle as argument
+ * @param   discDelay - service discovery delay in ms
+ * @param   pfnPoll - poll watchdog handler, called with the connection
+ *                    handle as argument
+ * @param   pollTimeout - longest poll of a link in ms
+ *
+ * @return  none
+ */
+void EBS_Conn_init(boardTimerCB_t pfnDisc, uint32_t discDelay,
+		boardTimerCB_t pfnPoll, uint32_t pollTimeout) {
+	uint8_t i;
+
+	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+	{
+		EBS_Conn_reset(&connCtx[i]);
+		connCtx[i].rssi.connHandle = GAP_CONNHANDLE_ALL;
+		Board_Timer_construct(&connCtx[i].discTmr, pfnDisc,
+				discDelay, 0, i);
+		Board_Timer_construct(&connCtx[i].pollTmr, pfnPoll,
+				pollTimeout, 0, i);
+	}
+
+	connPendingValid = FALSE;
+	numActive = 0;
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_find
+ *
+ * @brief   Get the context of a link.
+ *
+ * @param   connHandle - connection handle
+ *
+ * @return  context, NULL if the handle has no open context
+ */
+EbsConnCtx_t *EBS_Conn_find(uint16_t connHandle) {
+	if (connHandle >= MAX_NUM_BLE_CONNS
+			|| connCtx[connHandle].connHdl != connHandle)
+	{
+		return NULL;
+	}
+
+	return &connCtx[connHandle];
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_reserve
+ *
+ * @brief   Reserve the pending link for a Tx before establishing it.
+ *
+ * @param   rosterIdx - index of the Tx in discTxList
+ *
+ * @return  pending target to fill in, NULL if a link is already being
+ *          established or every context is in use
+ */
+TargetInfo_t *EBS_Conn_reserve(uint8_t rosterIdx) {
+	if (connPendingValid || numActive >= MAX_NUM_BLE_CONNS)
+	{
+		return NULL;
+	}
+
+	memset(&connPending, 0, sizeof(connPending));
+	connPending.rosterIdx = rosterIdx;
+	connPendingValid = TRUE;
+
+	return &connPending;
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_pending
+ *
+ * @brief   Get the target of the link being established.
+ *
+ * @return  pending target, NULL if none
+ */
+TargetInfo_t *EBS_Conn_pending(void) {
+	return connPendingValid ? &connPending : NULL;
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_cancel
+ *
+ * @brief   Drop the pending link after establishment failed.
+ *
+ * @return  none
+ */
+void EBS_Conn_cancel(void) {
+	connPendingValid = FALSE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_open
+ *
+ * @brief   Move the pending target into the context of its new link.
+ *
+ * @param   connHandle - connection handle of the established link
+ *
+ * @return  context, NULL if nothing was pending or the handle is out
+ *          of range
+ */
+EbsConnCtx_t *EBS_Conn_open(uint16_t connHandle) {
+	EbsConnCtx_t *pCtx;
+
+	if (!connPendingValid || connHandle >= MAX_NUM_BLE_CONNS)
+	{
+		connPendingValid = FALSE;
+		return NULL;
+	}
+
+	pCtx = &connCtx[connHandle];
+	EBS_Conn_reset(pCtx);
+	pCtx->connHdl = connHandle;
+	pCtx->target = connPending;
+	pCtx->pollState = EBS_POLL_STATE_CONNECT;
+
+	// The whole poll must finish before the watchdog fires
+	Board_Timer_start(&pCtx->pollTmr);
+
+	connPendingValid = FALSE;
+	numActive++;
+
+	return pCtx;
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_close
+ *
+ * @brief   Free the context of a terminated link.
+ *
+ * @param   connHandle - connection handle
+ *
+ * @return  none
+ */
+void EBS_Conn_close(uint16_t connHandle) {
+	EbsConnCtx_t *pCtx = EBS_Conn_find(connHandle);
+
+	if (pCtx != NULL)
+	{
+		Board_Timer_stop(&pCtx->discTmr);
+		Board_Timer_stop(&pCtx->pollTmr);
+		EBS_Conn_reset(pCtx);
+		numActive--;
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_Conn_numActive
+ *
+ * @brief   Number of open contexts.
+ *
+ * @return  number of links with a context
+ */
+uint8_t EBS_Conn_numActive(void) {
+	return numActive;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Conn_reset
+ *
+ * @brief   Clear the link state of a context, the timers and RSSI
+ *          reads are left alone.
+ *
+ * @param   pCtx - context
+ *
+ * @return  none
+ */
+static void EBS_Conn_reset(EbsConnCtx_t *pCtx) {
+	pCtx->connHdl = GAP_CONNHANDLE_INIT;
+	memset(&pCtx->target, 0, sizeof(pCtx->target));
+	pCtx->target.rosterIdx = EBS_ROSTER_IDX_NONE;
+	pCtx->pollState = EBS_POLL_STATE_IDLE;
+	pCtx->pollVer = 0;
+	pCtx->discState = EBS_DISC_STATE_IDLE;
+	pCtx->svcStartHdl = 0;
+	pCtx->svcEndHdl = 0;
+	memset(pCtx->charHdl, 0, sizeof(pCtx->charHdl));
+	pCtx->profileCounter = 0;
+	pCtx->procedureInProgress = FALSE;
+	EBS_RssiStat_reset(&pCtx->rssiStat);
+}
@@ -0,0 +1,117 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_conn.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		per-connection contexts indexed by connection handle
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_CONN_H_
+#define EVRS_BS_CONN_H_
+
+#include "bcomdef.h"
+#include "gap.h"
+#include "evrs_bs_typedefs.h"
+#include "evrs_bs_main.h"
+#include "board_timer.h"
+#include "evrs_bs_rssistat.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Invalid scan result index
+#define EBS_ROSTER_IDX_NONE			0xFF
+
+// Number of characteristics in the EVRS profile
+#define EVRSPROFILE_NUM_CHARS		4
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Discovery states
+typedef enum {
+	EBS_DISC_STATE_IDLE,                // Idle
+	EBS_DISC_STATE_MTU,                 // Exchange ATT MTU size
+	EBS_DISC_STATE_SVC,                 // Service discovery
+	EBS_DISC_STATE_CHAR                 // Characteristic discovery
+} EbsDiscState_t;
+
+// Polling states
+typedef enum {
+	EBS_POLL_STATE_IDLE,
+	EBS_POLL_STATE_CONNECT,
+	EBS_POLL_STATE_READ,
+	EBS_POLL_STATE_WRITE,
+	EBS_POLL_STATE_CMD,
+	EBS_POLL_STATE_TERMINATE
+} EbsPollState_t;
+
+typedef enum {
+	EVRSPROFILE_SYSID,
+	EVRSPROFILE_DEVID,
+	EVRSPROFILE_CMD,
+	EVRSPROFILE_DATA
+} ProfileId_t;
+
+// Tx being connected or polled
+typedef struct {
+	uint8_t addrType;	//!< Address Type: @ref ADDRTYPE_DEFINES
+	uint8_t addr[B_ADDR_LEN];	//!< Device's Address
+	uint8_t txDevID[ETX_DEVID_LEN];	// Tx Id
+	uint8_t rosterIdx;	// index in discTxList
+} TargetInfo_t;
+
+// Connection context, connCtx[connHandle] while the link is up
+typedef struct {
+	uint16_t connHdl;			// GAP_CONNHANDLE_INIT while the slot is free
+	TargetInfo_t target;		// Tx on the other end of the link
+	EbsPollState_t pollState;	// polling state
+	uint8_t pollVer;			// data version when the read was issued
+	uint16_t pollSeq;			// vote sequence read, acknowledged in the write
+	bool pollDrained;			// every vote read taken, none left at the Tx
+	uint8_t data[ETX_DATA_MAX_LEN];	// DATA value of the long read
+	uint8_t dataLen;			// length of data
+	uint8_t cmd[ETX_ACK_MAX_CMDS * ETX_CMD_LEN];	// commands for the Tx
+	uint8_t cmdLen;				// length of cmd
+	uint8_t cmdIdx;				// next command written in EBS_POLL_STATE_CMD
+	EbsDiscState_t discState;	// GATT discovery state
+	uint16_t svcStartHdl;		// discovered service start handle
+	uint16_t svcEndHdl;			// discovered service end handle
+	uint16_t charHdl[EVRSPROFILE_NUM_CHARS];	// discovered char handles
+	uint8_t profileCounter;		// number of characteristics found
+	bool procedureInProgress;	// GATT read/write procedure state
+	EbsRssiStat_t rssiStat;		// RSSI reads on the link
+	readRssi_t rssi;			// periodic RSSI reads
+	boardTimer_t discTmr;		// service discovery delay
+	boardTimer_t pollTmr;		// poll watchdog, ends a link stuck mid-poll
+} EbsConnCtx_t;
+
+/*********************************************************************
+ * EXTERNAL VARIABLES
+ */
+
+extern EbsConnCtx_t connCtx[MAX_NUM_BLE_CONNS];
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Conn_init(boardTimerCB_t pfnDisc, uint32_t discDelay,
+		boardTimerCB_t pfnPoll, uint32_t pollTimeout);
+extern EbsConnCtx_t *EBS_Conn_find(uint16_t connHandle);
+extern TargetInfo_t *EBS_Conn_reserve(uint8_t rosterIdx);
+extern TargetInfo_t *EBS_Conn_pending(void);
+extern void EBS_Conn_cancel(void);
+extern EbsConnCtx_t *EBS_Conn_open(uint16_t connHandle);
+extern void EBS_Conn_close(uint16_t connHandle);
+extern uint8_t EBS_Conn_numActive(void);
+
+#endif /* EVRS_BS_CONN_H_ */
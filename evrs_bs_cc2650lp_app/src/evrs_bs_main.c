@@ -16,6 +16,9 @@
 /*********************************************************************
  * INCLUDES
  */
+// Log site file ID, see board_log.h
+#define BOARD_LOG_FILE_ID		1
+
 #include <string.h>
 
 #include <ti/sysbios/knl/Task.h>
@@ -41,8 +44,20 @@
 #include "util.h"
 #include "board_key.h"
 #include "board_led.h"
+#include "board_timer.h"
+#include "board_msgq.h"
+#include "board_telemetry.h"
+#include "board_load.h"
 #include "board_display.h"
 #include "evrs_bs_rssi.h"
+#include "evrs_bs_advrpt.h"
+#include "evrs_bs_conn.h"
+#include "evrs_bs_rssistat.h"
+#include "evrs_bs_cmd.h"
+#include "evrs_bs_uplink.h"
+#include "evrs_bs_tally.h"
+#include "evrs_bs_vote.h"
+#include "evrs_bs_bcast.h"
 //#include <ti/mw/display/Display.h>
 #include "board.h"
 
@@ -56,12 +71,29 @@
  * CONSTANTS
  */
 
-// Maximum number of scan responses
-#define MAX_SCAN_RES		20
-
 // Scan duration in ms
 #define DEFAULT_SCAN_DURATION                 10000
 
+// Scan period in ms while polling, the scan restarts at the end of
+// each period so new Tx and data versions keep coming in
+#define DEFAULT_RESCAN_DURATION               2000
+
+// Scan interval and window (units of 0.625 ms) with no link up, the
+// host can change them with EBS_CMD_SET_SCAN
+#define DEFAULT_SCAN_INTERVAL                 16
+#define DEFAULT_SCAN_WINDOW                   16
+
+// Scan interval and window (units of 0.625 ms) while a link is up. The
+// window is shorter than the gap between two connection events, so the
+// controller can fit it in without the link missing its events.
+#define LINK_SCAN_INTERVAL                    160
+#define LINK_SCAN_WINDOW                      32
+
+// Shortest connection interval (units of 1.25 ms) the host may set,
+// LINK_SCAN_WINDOW plus 10 ms for the connection event. Shorter ones
+// leave the scan no room between two events.
+#define LINK_MIN_CONN_INTERVAL                (LINK_SCAN_WINDOW / 2 + 8)
+
 // Discovery mode (limited, general, all)
 #define DEFAULT_DISCOVERY_MODE                DEVDISC_MODE_ALL
 
@@ -77,11 +109,12 @@
 // TRUE to use white list when creating link
 #define LINK_WHITE_LIST               FALSE
 
-// Initial minimum connection interval (units of 1.25 ms.)
-#define INITIAL_MIN_CONN_INTERVAL 	      	  16
+// Initial minimum connection interval (units of 1.25 ms.), fixed at
+// 50 ms so LINK_SCAN_WINDOW fits between two connection events
+#define INITIAL_MIN_CONN_INTERVAL 	      	  40
 
 // Initial minimum connection interval (units of 1.25 ms.)
-#define INITIAL_MAX_CONN_INTERVAL             400
+#define INITIAL_MAX_CONN_INTERVAL             40
 
 // Initial slave latency
 #define INITIAL_SLAVE_LATENCY 		      	  0
@@ -92,6 +125,42 @@
 // Default RSSI polling period in ms
 #define DEFAULT_RSSI_PERIOD                   1000
 
+// RSSI read period on a polling link in ms, links only last a few
+// connection events
+#define LINK_RSSI_PERIOD                      100
+
+// RSSI summary report period in ms
+#define RSSI_REPORT_PERIOD                    5000
+
+// Most roster entries in one RSSI summary frame
+#define RSSI_REPORT_MAX_TX                    8
+
+// Length of one RSSI summary entry, Tx ID then packed statistics
+#define RSSI_REPORT_ENTRY_LEN   (ETX_DEVID_LEN + EBS_RSSISTAT_PACKED_LEN)
+
+// Most roster entries in one EBS_FRAME_ROSTER frame
+#define ROSTER_FRAME_MAX_TX                   16
+
+// Length of one roster entry: address type, address, Tx ID, data version
+#define ROSTER_ENTRY_LEN        (1 + B_ADDR_LEN + ETX_DEVID_LEN + 1)
+
+// Queue counter report period in ms
+#define QUEUE_REPORT_PERIOD                   5000
+
+// Memory telemetry report period in ms
+#define TELEMETRY_PERIOD                      10000
+
+// Vote tally snapshot period in ms
+#define TALLY_REPORT_PERIOD                   1000
+
+// SNV item of the question epoch, uint8
+#define EBS_EPOCH_NV_ID                       0x80
+
+// CPU load report period in ms
+#ifndef EBS_LOAD_REPORT_PERIOD
+#define EBS_LOAD_REPORT_PERIOD                5000
+#endif
+
 // Whether to enable automatic parameter update request when a connection is
 // formed
 #define DEFAULT_ENABLE_UPDATE_REQUEST         FALSE
@@ -114,12 +183,26 @@
 // Default service discovery timer delay in ms
 #define SVC_DISCOVERY_DELAY           500
 
+// Longest poll of a link in ms, from link up to terminate. A link still
+// up then lost a GATT procedure and is dropped.
+#ifndef EBS_POLL_TIMEOUT
+#define EBS_POLL_TIMEOUT              5000
+#endif
+
 // TRUE to filter discovery results on desired service UUID
 #define DEV_DISC_BY_SVC_UUID          TRUE
 
 // Length of bd addr as a string
 #define B_ADDR_STR_LEN                        15
 
+// Most low lane app messages and advert reports serviced per wakeup
+#define EBS_LOW_LANE_BUDGET                   4
+#define EBS_ADVRPT_BUDGET                     8
+
+// Most app messages queued per lane, each one holds ICall heap
+#define EBS_HIGH_LANE_DEPTH                   12
+#define EBS_LOW_LANE_DEPTH                    6
+
 // Task configuration
 #define EBS_TASK_PRIORITY                     1
 
@@ -127,19 +210,6 @@
 #define EBS_TASK_STACK_SIZE                   864
 #endif
 
-// GATT Params
-// EVRS Profile Service UUID
-#define EVRSPROFILE_SERV_UUID 			0xAFF0
-#define EVRSPROFILE_SYSID_UUID         	0xAFF2
-#define EVRSPROFILE_DEVID_UUID      	0xAFF4
-#define EVRSPROFILE_CMD_UUID        	0xAFF8
-#define EVRSPROFILE_DATA_UUID         	0xAFFE
-
-#define ETX_ADTYPE_DEST				0xAF
-#define ETX_ADTYPE_DEVID			0xAE
-#define ETX_DEVID_LEN 				4
-#define ETX_DEVID_PREFIX			0x95
-
 // Application states
 typedef enum {
 	EBS_STATE_INIT,
@@ -148,30 +218,6 @@ typedef enum {
 	EBS_STATE_POLLING
 } EbsState_t;
 
-// Discovery states
-typedef enum {
-	EBS_DISC_STATE_IDLE,                // Idle
-	EBS_DISC_STATE_MTU,                 // Exchange ATT MTU size
-	EBS_DISC_STATE_SVC,                 // Service discovery
-	EBS_DISC_STATE_CHAR                 // Characteristic discovery
-} EbsDiscState_t;
-
-// Polling states
-typedef enum {
-	EBS_POLL_STATE_IDLE,
-	EBS_POLL_STATE_CONNECT,
-	EBS_POLL_STATE_READ,
-	EBS_POLL_STATE_WRITE,
-	EBS_POLL_STATE_TERMINATE
-} EbsPollState_t;
-
-typedef enum {
-	EVRSPROFILE_SYSID,
-	EVRSPROFILE_DEVID,
-	EVRSPROFILE_CMD,
-	EVRSPROFILE_DATA
-} ProfileId_t;
-
 
 /*********************************************************************
  * TYPEDEFS
@@ -183,6 +229,22 @@ typedef struct {
 	uint8_t *pData;  // event data
 } EbsEvt_t;
 
+// App message lanes, in service order
+typedef enum {
+	EBS_LANE_HIGH,	// link, pairing and state events, serviced completely
+	EBS_LANE_LOW,	// keys, serviced within a budget
+	EBS_NUM_LANES
+} EbsLane_t;
+
+// CPU load slots, UART output is BOARD_LOAD_SLOT_DISPLAY
+typedef enum {
+	EBS_LOAD_STACK = BOARD_LOAD_SLOT_APP,	// stack messages
+	EBS_LOAD_APPMSG,						// app message lanes
+	EBS_LOAD_ADVRPT,						// advert report handling
+	EBS_LOAD_TIMER,							// app timer handlers
+	EBS_NUM_LOAD_SLOTS
+} EbsLoadSlot_t;
+
 
 /**
  * Type of device discovery (Scan) to perform.
@@ -192,17 +254,19 @@ typedef struct {
 	uint8_t addrType;	//!< Address Type: @ref ADDRTYPE_DEFINES
 	uint8_t addr[B_ADDR_LEN];	//!< Device's Address
 	uint8_t txDevID[ETX_DEVID_LEN];	// Tx Id
+	uint8_t dataVer;	// data version last seen in the advert
+	uint8_t ackVer;		// data version at the last acknowledged poll
+	bool acked;			// ackVer valid
+	bool queued;		// waiting in pollQueue
+	bool linked;		// link being established or up
+	EbsRssiStat_t rssiStat;	// advert reports and link reads
+	int8_t txPower;		// output power in dBm, EBS_TXPWR_UNKNOWN until seen
+	int8_t cmdPower;	// output power to command on the next poll
+	uint8_t txEpoch;	// epoch the Tx stamps its votes with
+	bool ackPlain;		// Tx takes only a bare acknowledgement, commands
+						// go to CMD one write each
 } DevRecInfo_t;
 
-
-typedef struct {
-	uint8_t addrType;	//!< Address Type: @ref ADDRTYPE_DEFINES
-	uint8_t addr[B_ADDR_LEN];	//!< Device's Address
-	uint8_t txDevID[ETX_DEVID_LEN];	// Tx Id
-	uint16_t connHdl;	// connection handle
-	EbsPollState_t state; // connection state
-} TargetInfo_t;
-
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -224,18 +288,11 @@ static ICall_EntityID selfEntity;
 // Semaphore globally used to post events to the application thread
 static ICall_Semaphore sem;
 
-// Clock object used to signal timeout
-static Clock_Struct startDiscClock;
-
-// Clock object used to timeout connection
-static Clock_Struct connectingClock;
+// Timer used to timeout connection
+static boardTimer_t connectingTmr;
 
 // Queue object used for app messages
-static Queue_Struct appMsg;
-static Queue_Handle appMsgQueue;
-
-// Task pending events
-static uint16_t events = 0;
+static boardMsgLane_t appLanes[EBS_NUM_LANES];
 
 // Task configuration
 Task_Struct ebsTask;
@@ -251,9 +308,40 @@ static uint8_t scanIdx;
 // Scan result list
 static DevRecInfo_t discTxList[MAX_SCAN_RES];
 
+// FIFO of discTxList indices whose data changed since the last
+// acknowledged poll, each index is queued at most once
+static uint8_t pollQueue[MAX_SCAN_RES];
+static uint8_t pollQueueHead = 0;
+static uint8_t pollQueueCount = 0;
+
+// Question epoch, votes cast in another one are stale and dropped
+static uint8_t voteEpoch = 0;
+static uint32_t staleVotes = 0;
+
 // Scanning state
 static bool scanningStarted = FALSE;
 
+// RSSI summary report timer, and the next roster entry to report
+static boardTimer_t rssiReportTmr;
+static uint8_t rssiReportIdx = 0;
+
+// Queue counter report timer
+static boardTimer_t queueReportTmr;
+
+// Memory telemetry report timer
+static boardTimer_t telemetryTmr;
+
+// CPU load report timer
+static boardTimer_t loadReportTmr;
+
+// Vote tally snapshot timer
+static boardTimer_t tallyReportTmr;
+
+// Scan parameters with no link up, see EBS_CMD_SET_SCAN
+static uint16_t scanInterval = DEFAULT_SCAN_INTERVAL;
+static uint16_t scanWindow = DEFAULT_SCAN_WINDOW;
+static uint16_t scanDuration = DEFAULT_SCAN_DURATION;
+
 // Connection handle of current connection
 //static uint16_t connHandleList[MAX_NUM_BLE_CONNS] = GAP_CONNHANDLE_INIT;
 
@@ -261,38 +349,12 @@ static bool scanningStarted = FALSE;
 static EbsState_t ebsState = EBS_STATE_INIT;
 //static bleState_t state = BLE_STATE_IDLE;
 
-// Discovery state
-static EbsDiscState_t discState = EBS_DISC_STATE_IDLE;
-
-// Discovered service start and end handle
-static uint16_t svcStartHdl = 0;
-static uint16_t svcEndHdl = 0;
-
-// Discovered characteristic handle
-static uint16_t charHdl[4] = {0};
-
-// GATT read/write procedure state
-static bool procedureInProgress = FALSE;
-
 // Maximum PDU size (default = 27 octets)
 static uint16_t maxPduSize;
 
-// Array of RSSI read structures
-readRssi_t readRssi[MAX_NUM_BLE_CONNS];
-
-// counter for profile found
-int profileCounter = 0;
-
 // Base Station Identifier
 uint8_t baseStationID = 0x02;
 
-// Target Tx List
-TargetInfo_t targetList[MAX_NUM_BLE_CONNS];
-TargetInfo_t* pVacantSlot = targetList;
-TargetInfo_t* pConnectingSlot = NULL;
-
-Semaphore_Handle targetConnSem;
-
 // test
 int tcounter = 0;
 
@@ -306,21 +368,24 @@ static void EBS_processGATTMsg(gattMsgEvent_t *pMsg);
 static void EBS_handleKeys(uint8_t shift, uint8_t keys);
 static void EBS_processStackMsg(ICall_Hdr *pMsg);
 static void EBS_processAppMsg(EbsEvt_t *pMsg);
+static void EBS_serviceAppMsg(uint8_t *pMsg);
 static void EBS_processRoleEvent(gapCentralRoleEvent_t *pEvent);
-static void EBS_processGATTDiscEvent(gattMsgEvent_t *pMsg);
-static uint8_t EBS_writeCharbyHandle(uint16_t connHandle, ProfileId_t charHdlId,
+static void EBS_processGATTDiscEvent(EbsConnCtx_t *pCtx, gattMsgEvent_t *pMsg);
+static uint8_t EBS_writeCharbyHandle(EbsConnCtx_t *pCtx, ProfileId_t charHdlId,
 		uint8_t* pData, uint8_t len);
-static uint8_t EBS_readCharbyHandle(uint16_t connHandle, ProfileId_t charHdlId);
-static void EBS_startDiscovery(void);
-static bool EBS_findSvcUuid(uint16_t uuid, uint8_t *pData,
+static uint8_t EBS_readCharbyHandle(EbsConnCtx_t *pCtx, ProfileId_t charHdlId);
+static void EBS_takeData(EbsConnCtx_t *pCtx);
+static bool EBS_takeVote(EbsConnCtx_t *pCtx, const uint8_t *pData,
 		uint8_t dataLen);
+static void EBS_startDiscovery(EbsConnCtx_t *pCtx);
 static void EBS_discoverDevices(void);
-void EBS_timeoutConnecting(UArg arg0);
-static bool EBS_checkBSId(uint8_t bsID, uint8_t *pEvtData, uint8_t dataLen);
-static void EBS_addDeviceInfo(uint8_t *pAddr, uint8_t addrType);
+static void EBS_timeoutConnecting(UArg arg0);
+static void EBS_startScan(uint16_t duration);
+static void EBS_resumeScan(void);
+static uint8_t EBS_findDeviceInfo(uint8_t *pAddr);
+static uint8_t EBS_addDeviceInfo(uint8_t *pAddr, uint8_t addrType);
 // static bool EBS_findLocalName(uint8_t *pEvtData, uint8_t dataLen);
-static void EBS_addDeviceID(uint8_t index, uint8_t *pEvtData,
-		uint8_t dataLen);
+static void EBS_processAdvRec(EbsAdvRec_t *pRec);
 static void EBS_processPairState(uint8_t pairState, uint8_t status);
 //static void EBS_processPasscode(uint16_t connectionHandle,
 //		uint8_t uiOutputs);
@@ -333,14 +398,34 @@ static uint8_t EBS_eventCB(gapCentralRoleEvent_t *pEvent);
 static void EBS_pairStateCB(uint16_t connHandle, uint8_t pairState,
 		uint8_t status);
 
-void EBS_startDiscHandler(UArg a0);
+static void EBS_startDiscHandler(UArg a0);
+static void EBS_pollTimeoutHandler(UArg a0);
+static void EBS_timerWakeHandler(void);
 void EBS_keyChangeHandler(uint8_t keys);
 
 static void EBS_updateEbsState(EbsState_t newState);
 static void EBS_stateChange(EbsState_t newState);
-static void EBS_updatePollState(uint8_t targetIndex, EbsPollState_t newState);
-
-static void EBS_updateTargetList(uint8_t* txID);
+static void EBS_updatePollState(EbsConnCtx_t *pCtx, EbsPollState_t newState);
+
+static void EBS_connectTarget(uint8_t index);
+static bool EBS_pollDue(DevRecInfo_t *pDev);
+static void EBS_queuePoll(uint8_t index);
+static void EBS_queueAllPolls(void);
+static void EBS_queueEpochPolls(void);
+static uint8_t EBS_packTxCmds(DevRecInfo_t *pDev, uint8_t *pBuf);
+static void EBS_txCmdDone(DevRecInfo_t *pDev, const uint8_t *pCmd);
+static void EBS_setEpoch(uint8_t epoch);
+static void EBS_scheduleNextPoll(void);
+static void EBS_reportRssiStats(UArg a0);
+static void EBS_reportQueueStats(UArg a0);
+static void EBS_reportTelemetry(UArg a0);
+static void EBS_reportLoad(UArg a0);
+static void EBS_reportTally(UArg a0);
+static void EBS_uploadRoster(void);
+static boardTimerCB_t EBS_findReport(uint8_t frameType,
+		boardTimer_t **ppTimer);
+static void EBS_processHostCmd(uint8_t *pCmd);
+static uint8_t EBS_findDeviceByID(uint8_t *pTxDevID);
 
 static uint32_t EBS_parseDevID(uint8_t* devID);
 
@@ -397,8 +482,6 @@ void EBS_createTask(void) {
  * @return  none
  */
 static void EBS_init(void) {
-	uint8_t i;
-
 	// ******************************************************************
 	// N0 STACK API CALLS CAN OCCUR BEFORE THIS CALL TO ICall_registerApp
 	// ******************************************************************
@@ -407,11 +490,54 @@ static void EBS_init(void) {
 	ICall_registerApp(&selfEntity, &sem);
 
 	// Create an RTOS queue for message from profile to be sent to app.
-	appMsgQueue = Util_constructQueue(&appMsg);
+	{
+		Board_MsgQ_construct(&appLanes[EBS_LANE_HIGH], EBS_HIGH_LANE_DEPTH);
+		Board_MsgQ_construct(&appLanes[EBS_LANE_LOW], EBS_LOW_LANE_DEPTH);
+	}
 
-	// Setup discovery delay as a one-shot timer
-	Util_constructClock(&startDiscClock, EBS_startDiscHandler,
-	SVC_DISCOVERY_DELAY, 0, false, 0);
+	// App timers share one RTOS clock and fire in this task
+	Board_Timer_init(EBS_timerWakeHandler);
+
+	// Setup the connection contexts, with a one-shot service discovery
+	// delay per link
+	EBS_Conn_init(EBS_startDiscHandler, SVC_DISCOVERY_DELAY,
+			EBS_pollTimeoutHandler, EBS_POLL_TIMEOUT);
+
+	// One RSSI read tick shared by every link
+	EBS_RssiInit();
+
+	// Stream RSSI summaries to the host
+	Board_Timer_construct(&rssiReportTmr, EBS_reportRssiStats,
+	RSSI_REPORT_PERIOD, RSSI_REPORT_PERIOD, 0);
+	Board_Timer_start(&rssiReportTmr);
+
+	// Stream queue depths and drops to the host
+	Board_Timer_construct(&queueReportTmr, EBS_reportQueueStats,
+	QUEUE_REPORT_PERIOD, QUEUE_REPORT_PERIOD, 0);
+	Board_Timer_start(&queueReportTmr);
+
+	// Stream stack, heap and queue usage to the host
+	Board_Timer_construct(&telemetryTmr, EBS_reportTelemetry,
+	TELEMETRY_PERIOD, TELEMETRY_PERIOD, 0);
+	Board_Timer_start(&telemetryTmr);
+
+	// Meter this task and stream its CPU load to the host
+	Board_Load_init();
+	Board_Timer_construct(&loadReportTmr, EBS_reportLoad,
+	EBS_LOAD_REPORT_PERIOD, EBS_LOAD_REPORT_PERIOD, 0);
+	Board_Timer_start(&loadReportTmr);
+
+	// Carry on with the question epoch from before the reset, then
+	// stream vote tally snapshots to the host
+	if (osal_snv_read(EBS_EPOCH_NV_ID, sizeof(voteEpoch),
+			(uint8 *) &voteEpoch) != SUCCESS)
+	{
+		voteEpoch = 0;
+	}
+	EBS_Tally_reset(voteEpoch);
+	Board_Timer_construct(&tallyReportTmr, EBS_reportTally,
+	TALLY_REPORT_PERIOD, TALLY_REPORT_PERIOD, 0);
+	Board_Timer_start(&tallyReportTmr);
 
 	// Set initial connection parameter values
 	GAP_SetParamValue(TGAP_CONN_EST_INT_MIN, INITIAL_MIN_CONN_INTERVAL);
@@ -419,23 +545,28 @@ static void EBS_init(void) {
 	GAP_SetParamValue(TGAP_CONN_EST_SUPERV_TIMEOUT, INITIAL_CONN_TIMEOUT);
 	GAP_SetParamValue(TGAP_CONN_EST_LATENCY, INITIAL_SLAVE_LATENCY);
 
-	// Construct clock for connecting timeout
-	Util_constructClock(&connectingClock, EBS_timeoutConnecting,
-	DEFAULT_SCAN_DURATION, 0, false, 0);
+	// Construct timer for connecting timeout
+	Board_Timer_construct(&connectingTmr, EBS_timeoutConnecting,
+	DEFAULT_SCAN_DURATION, 0, 0);
 
 	Board_initKeys(EBS_keyChangeHandler);
 	Board_initLEDs();
 	Board_Display_Init();
 
-	// Initialize internal data
-	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
-	{
-		readRssi[i].connHandle = GAP_CONNHANDLE_ALL;
-		readRssi[i].pClock = NULL;
-	}
+	// Take commands from the host on the same UART
+	EBS_Cmd_init();
+
+	// Votes go to the host as the host grants credit
+	EBS_Uplink_init();
+
+	// Tx commands that concern every Tx go out in one advertising burst
+	EBS_Bcast_init(selfEntity, baseStationID);
 
 	// Setup Central Profile
 	{
+		// The role keeps its own device list in the ICall heap during
+		// discovery, 0 would leave it unbounded. Cap it at the roster
+		// size, advertisers past that have no discTxList slot anyway.
 		uint8_t maxScanRes = MAX_SCAN_RES;
 
 		GAPCentralRole_SetParameter(GAPCENTRALROLE_MAX_SCAN_RES,
@@ -490,7 +621,6 @@ static void EBS_init(void) {
 	// Register for GATT local events and ATT Responses pending for transmission
 	GATT_RegisterForMsgs(selfEntity);
 
-	targetConnSem = Semaphore_create(0, NULL, NULL);
 	Board_ledControl(BOARD_LED_ID_G, BOARD_LED_STATE_FLASH, 300);
 }
 
@@ -510,6 +640,8 @@ static void EBS_taskFxn(UArg a0, UArg a1) {
 	// Application main loop
 	for (;;)
 	{
+		boardLoadMark_t mark;
+
 		// Waits for a signal to the semaphore associated with the calling thread.
 		// Note that the semaphore associated with a thread is signaled when a
 		// message is queued to the message receive queue of the thread or when
@@ -528,7 +660,9 @@ static void EBS_taskFxn(UArg a0, UArg a1) {
 				if ((src == ICALL_SERVICE_CLASS_BLE) && (dest == selfEntity))
 				{
 					// Process inter-task message
+					Board_Load_enter(EBS_LOAD_STACK, &mark);
 					EBS_processStackMsg((ICall_Hdr *) pMsg);
+					Board_Load_exit(&mark);
 				}
 
 				if (pMsg)
@@ -538,25 +672,33 @@ static void EBS_taskFxn(UArg a0, UArg a1) {
 			}
 		}
 
-		// If RTOS queue is not empty, process app message
-		while (!Queue_empty(appMsgQueue))
-		{
-			EbsEvt_t *pMsg = (EbsEvt_t *) Util_dequeueMsg(appMsgQueue);
-			if (pMsg)
-			{
-				// Process message
-				EBS_processAppMsg(pMsg);
+		// Connection critical app messages first, all of them
+		Board_Load_enter(EBS_LOAD_APPMSG, &mark);
+		Board_MsgQ_service(&appLanes[EBS_LANE_HIGH], EBS_serviceAppMsg, 0);
+		Board_Load_exit(&mark);
 
-				// Free the space from the message
-				ICall_free(pMsg);
-			}
-		}
+		// Fire the app timers that are due
+		Board_Load_enter(EBS_LOAD_TIMER, &mark);
+		Board_Timer_process();
+		Board_Load_exit(&mark);
 
-		if (events & EBS_START_DISCOVERY_EVT)
-		{
-			events &= ~EBS_START_DISCOVERY_EVT;
+		// Then a bounded share of the low value work
+		Board_Load_enter(EBS_LOAD_APPMSG, &mark);
+		Board_MsgQ_service(&appLanes[EBS_LANE_LOW], EBS_serviceAppMsg,
+				EBS_LOW_LANE_BUDGET);
+		Board_Load_exit(&mark);
+
+		Board_Load_enter(EBS_LOAD_ADVRPT, &mark);
+		EBS_AdvRpt_drain(EBS_processAdvRec, EBS_ADVRPT_BUDGET);
+		Board_Load_exit(&mark);
+
+		// Send the log records of this wakeup in one frame
+		Board_Log_flush();
 
-			EBS_startDiscovery();
+		// Come back for the rest once the stack had its turn
+		if (Board_MsgQ_pending(&appLanes[EBS_LANE_LOW]) || EBS_AdvRpt_pending())
+		{
+			Semaphore_post(sem);
 		}
 	}
 }
@@ -602,6 +744,19 @@ static void EBS_processStackMsg(ICall_Hdr *pMsg) {
 	}
 }
 
+/*********************************************************************
+ * @fn      EBS_serviceAppMsg
+ *
+ * @brief   App message lane handler.
+ *
+ * @param   pMsg - queued EbsEvt_t, freed by the lane
+ *
+ * @return  none
+ */
+static void EBS_serviceAppMsg(uint8_t *pMsg) {
+	EBS_processAppMsg((EbsEvt_t *) pMsg);
+}
+
 /*********************************************************************
  * @fn      EBS_processAppMsg
  *
@@ -629,21 +784,10 @@ static void EBS_processAppMsg(EbsEvt_t *pMsg) {
 			EBS_handleKeys(0, pMsg->hdr.state);
 			break;
 
-		case EBS_RSSI_READ_EVT:
-		{
-			readRssi_t *pRssi = (readRssi_t *) pMsg->pData;
-
-			// If link is up and RSSI reads active
-			if (pRssi->connHandle != GAP_CONNHANDLE_ALL
-					&& linkDB_Up(pRssi->connHandle))
-			{
-				// Restart timer
-				Util_restartClock(pRssi->pClock, pRssi->period);
+		case EBS_HOST_CMD_EVT:
+			EBS_processHostCmd(pMsg->pData);
 
-				// Read RSSI
-				VOID HCI_ReadRssiCmd(pRssi->connHandle);
-			}
-		}
+			ICall_free(pMsg->pData);
 			break;
 
 			// Pairing event
@@ -664,12 +808,6 @@ static void EBS_processAppMsg(EbsEvt_t *pMsg) {
 			break;
 		}
 		*/
-			// Connecting to device timed out
-		case EBS_CONNECTING_TIMEOUT_EVT:
-		{
-			GAPCentralRole_TerminateLink(pConnectingSlot->connHdl);
-		}
-
 		default:
 			// Do nothing.
 			break;
@@ -692,105 +830,130 @@ static void EBS_processRoleEvent(gapCentralRoleEvent_t *pEvent) {
 		{
 			maxPduSize = pEvent->initDone.dataPktLen;
 			uout0("EVRS BS initialized");
-			uout0(Util_convertBdAddr2Str(pEvent->initDone.devAddr));
+			uout2("BS Addr 0x%04x%08x",
+					BOARD_LOG_ADDR_HI(pEvent->initDone.devAddr),
+					BOARD_LOG_ADDR_LO(pEvent->initDone.devAddr));
 			uout1("BS ID: 0x%02x", baseStationID);
 		}
 			break;
 
-		case GAP_DEVICE_INFO_EVENT:
+		case GAP_DEVICE_DISCOVERY_EVENT:
 		{
+			// discovery complete, the role device list is not used,
+			// discTxList holds the results
+			scanningStarted = FALSE;
+			// initialize scan index to first
+			scanIdx = 0;
 
-			//Find tx device address by UUID
-			if (EBS_findSvcUuid(EVRSPROFILE_SERV_UUID,
-					pEvent->deviceInfo.pEvtData, pEvent->deviceInfo.dataLen) &&
-				EBS_checkBSId(baseStationID,
-					pEvent->deviceInfo.pEvtData, pEvent->deviceInfo.dataLen))
+			if (ebsState == EBS_STATE_POLLING)
 			{
-				EBS_addDeviceInfo(pEvent->deviceInfo.addr,
-						pEvent->deviceInfo.addrType);
-			}
-
-			// Check if the discovered device is already in scan results
-			uint8_t index;
-			for (index = 0; index < scanRes; index++)
+				// Scan period over or scan cancelled for a connection,
+				// poll the next changed Tx then keep scanning
+				EBS_scheduleNextPoll();
+				EBS_resumeScan();
+			} else
 			{
-				if (memcmp(pEvent->deviceInfo.addr, discTxList[index].addr, B_ADDR_LEN)
-						== 0)
-				{
-					//Update deviceInfo entry with the name
-					EBS_addDeviceID(index,
-							pEvent->deviceInfo.pEvtData,
-							pEvent->deviceInfo.dataLen);
-				}
+				uout1("%d Device(s) found", scanRes);
+				EBS_updateEbsState(EBS_STATE_UPLOAD);
 			}
 		}
 			break;
 
-		case GAP_DEVICE_DISCOVERY_EVENT:
-		{
-			// discovery complete
-			scanningStarted = FALSE;
-			// initialize scan index to first
-			scanIdx = 0;
-			uout1("%d Device(s) found", scanRes);
-			EBS_updateEbsState(EBS_STATE_UPLOAD);
-		}
+		case GAP_MAKE_DISCOVERABLE_DONE_EVENT:
+		case GAP_END_DISCOVERABLE_DONE_EVENT:
+		case GAP_ADV_DATA_UPDATE_DONE_EVENT:
+			if (pEvent->gap.hdr.status != SUCCESS)
+			{
+				ulog2(WARN, "Bcast 0x%02x failed 0x%02x", pEvent->gap.opcode,
+						pEvent->gap.hdr.status);
+			}
+			if (EBS_Bcast_processEvent(&pEvent->gap))
+			{
+				// No Tx confirms a broadcast, poll the ones not seen on
+				// the current epoch yet
+				EBS_queueEpochPolls();
+			}
 			break;
 
 		case GAP_LINK_ESTABLISHED_EVENT:
 		{
+			uint16_t connHandle = pEvent->linkCmpl.connectionHandle;
+
+			Board_Timer_stop(&connectingTmr);
+
 			if (pEvent->gap.hdr.status == SUCCESS)
 			{
-				//Connect to selected device
-				//state = BLE_STATE_CONNECTED;
-				//connHandle = pEvent->linkCmpl.connectionHandle;
-				procedureInProgress = TRUE;
+				TargetInfo_t *pTarget = EBS_Conn_pending();
+				uint8_t index = pTarget ? pTarget->rosterIdx : EBS_ROSTER_IDX_NONE;
 
-				// If service discovery not performed initiate service discovery
-				if (charHdl[0] == 0)
-				{
-					Util_startClock(&startDiscClock);
-				}
+				// Pending target becomes the context of the new link
+				EbsConnCtx_t *pCtx = EBS_Conn_open(connHandle);
 
-				//Find device ID in discTxList struct
-				uint8_t i;
-				for (i = 0; i < scanRes; i++)
+				if (pCtx == NULL)
 				{
-					if (memcmp(pEvent->linkCmpl.devAddr, targetList[i].addr,
-					B_ADDR_LEN) == NULL)
+					// Not a link this app can track
+					GAPCentralRole_TerminateLink(connHandle);
+					if (index < scanRes)
 					{
-						break;
+						discTxList[index].linked = FALSE;
 					}
-				}
-				targetList[i].connHdl = pEvent->linkCmpl.connectionHandle;
-				uout1("Tx ID 0x%08x Connected", EBS_parseDevID(targetList[i].txDevID));
-				uout1("Tx Addr %s", Util_convertBdAddr2Str(pEvent->linkCmpl.devAddr));
+				} else
+				{
+					pCtx->procedureInProgress = TRUE;
+
+					// Initiate service discovery after a delay
+					Board_Timer_start(&pCtx->discTmr);
+
+					// Sample link quality while the link is up
+					EBS_StartRssi(connHandle, LINK_RSSI_PERIOD);
 
+					uout1("Tx ID 0x%08x Connected",
+							EBS_parseDevID(pCtx->target.txDevID));
+					ulog2(DEBUG, "Tx Addr 0x%04x%08x",
+							BOARD_LOG_ADDR_HI(pEvent->linkCmpl.devAddr),
+							BOARD_LOG_ADDR_LO(pEvent->linkCmpl.devAddr));
+				}
 			} else
 			{
-				//connHandle = GAP_CONNHANDLE_INIT;
-				discState = EBS_DISC_STATE_IDLE;
+				TargetInfo_t *pTarget = EBS_Conn_pending();
+
+				if (pTarget != NULL && pTarget->rosterIdx < scanRes)
+				{
+					discTxList[pTarget->rosterIdx].linked = FALSE;
+				}
+				EBS_Conn_cancel();
 
-				uout1("Connect Failed: 0x%02x",pEvent->gap.hdr.status);
+				ulog1(WARN, "Connect Failed: 0x%02x",pEvent->gap.hdr.status);
+
+				// Move on to the next changed Tx
+				EBS_scheduleNextPoll();
 			}
+
+			// Scan alongside the link
+			EBS_resumeScan();
 		}
 			break;
 
 		case GAP_LINK_TERMINATED_EVENT:
 		{
-			//state = BLE_STATE_IDLE;
-			//connHandle = GAP_CONNHANDLE_INIT;
-			discState = EBS_DISC_STATE_IDLE;
-			memset(charHdl,0x00,4);
-			profileCounter = 0;
-			procedureInProgress = FALSE;
-			EBS_updatePollState(1, EBS_POLL_STATE_IDLE);
+			uint16_t connHandle = pEvent->linkTerminate.connectionHandle;
+			EbsConnCtx_t *pCtx = EBS_Conn_find(connHandle);
+
+			if (pCtx != NULL && pCtx->target.rosterIdx < scanRes)
+			{
+				discTxList[pCtx->target.rosterIdx].linked = FALSE;
+			}
 
 			// Cancel RSSI reads
-			EBS_CancelRssi(pEvent->linkTerminate.connectionHandle);
+			EBS_CancelRssi(connHandle);
+
+			EBS_Conn_close(connHandle);
 
 			//Clear screen and display disconnect reason
 			uout1("Disconnected: 0x%02x", pEvent->linkTerminate.reason);
+
+			// Move on to the next changed Tx
+			EBS_scheduleNextPoll();
 		}
 			break;
 		/*
@@ -825,45 +988,131 @@ static void EBS_processRoleEvent(gapCentralRoleEvent_t *pEvent) {
  * @return  none
  */
 static void EBS_processGATTMsg(gattMsgEvent_t *pMsg) {
-	if (ebsState == EBS_STATE_POLLING)
+	// GATT traffic follows the links, whatever the app state
+	EbsConnCtx_t *pCtx = EBS_Conn_find(pMsg->connHandle);
+
+	if (pCtx != NULL)
 	{
 		// See if GATT server was unable to transmit an ATT response
 		if (pMsg->hdr.status == blePending)
 		{
 			// No HCI buffer was available. App can try to retransmit the response
 			// on the next connection event. Drop it for now.
-			uout1("ATT Rsp drped %d", pMsg->method);
-		} else if ((pMsg->method == ATT_READ_RSP)
+			ulog1(WARN, "ATT Rsp drped %d", pMsg->method);
+		} else if ((pMsg->method == ATT_READ_BLOB_RSP)
 				|| ((pMsg->method == ATT_ERROR_RSP)
-						&& (pMsg->msg.errorRsp.reqOpcode == ATT_READ_REQ)))
+						&& (pMsg->msg.errorRsp.reqOpcode == ATT_READ_BLOB_REQ)))
 		{
 			if (pMsg->method == ATT_ERROR_RSP)
 			{
-				uout1("Read Error 0x%02x", pMsg->msg.errorRsp.errCode);
+				// Nothing to forward, poll it again later
+				ulog1(WARN, "Read Error 0x%02x", pMsg->msg.errorRsp.errCode);
+				EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+				pCtx->procedureInProgress = FALSE;
 			} else
 			{
-				// After a successful read, display the read value
-				uout1("Read rsp: 0x%02x", pMsg->msg.readRsp.pValue[0]);
-				EBS_updatePollState(0, EBS_POLL_STATE_WRITE);
-			}
+				uint16_t len = pMsg->msg.readBlobRsp.len;
+
+				// Gather the blobs, the last message completes the read
+				if (len > ETX_DATA_MAX_LEN - pCtx->dataLen)
+				{
+					len = ETX_DATA_MAX_LEN - pCtx->dataLen;
+				}
+				memcpy(&pCtx->data[pCtx->dataLen], pMsg->msg.readBlobRsp.pValue,
+						len);
+				pCtx->dataLen += len;
 
-			procedureInProgress = FALSE;
+				if (pMsg->hdr.status == bleProcedureComplete)
+				{
+					ulog1(DEBUG, "Read rsp: %d bytes", pCtx->dataLen);
+					EBS_takeData(pCtx);
+					pCtx->procedureInProgress = FALSE;
+				}
+			}
 		} else if ((pMsg->method == ATT_WRITE_RSP)
 				|| ((pMsg->method == ATT_ERROR_RSP)
 						&& (pMsg->msg.errorRsp.reqOpcode == ATT_WRITE_REQ)))
 		{
 			if (pMsg->method == ATT_ERROR_RSP)
 			{
-				uout1("Write Error 0x%02x", pMsg->msg.errorRsp.errCode);
+				uint8_t index = pCtx->target.rosterIdx;
+
+				ulog1(WARN, "Write Error 0x%02x", pMsg->msg.errorRsp.errCode);
+
+				if (pCtx->pollState == EBS_POLL_STATE_WRITE && index < scanRes
+						&& !discTxList[index].ackPlain && pCtx->pollDrained)
+				{
+					// Older Tx firmware refuses the commands, acknowledge
+					// bare and send them to CMD from now on. Not with votes
+					// left in the journal, a bare mark would free them too.
+					discTxList[index].ackPlain = TRUE;
+					EBS_updatePollState(pCtx, EBS_POLL_STATE_WRITE);
+				} else if (pCtx->pollState == EBS_POLL_STATE_CMD)
+				{
+					// The data is already acknowledged, a rejected command
+					// only ends the poll
+					EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+				} else
+				{
+					// Nothing left to try on this link, poll it again later
+					EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+				}
 			} else
 			{
-				// After a successful write, display the value that was written and
-				// increment value
-				uout0("Write done");
-				EBS_updatePollState(0, EBS_POLL_STATE_TERMINATE);
+				uint8_t index = pCtx->target.rosterIdx;
+
+				if (pCtx->pollState == EBS_POLL_STATE_WRITE && index < scanRes)
+				{
+					DevRecInfo_t *pDev = &discTxList[index];
+
+					// The Tx data is acknowledged up to the version read,
+					// unless votes were left in its journal
+					if (pCtx->pollDrained)
+					{
+						pDev->ackVer = pCtx->pollVer;
+						pDev->acked = TRUE;
+					}
+					ulog0(DEBUG, "Write done");
+
+					// The commands went with the acknowledgement, or are
+					// written to CMD one by one while the link is up
+					pCtx->cmdIdx = 0;
+					if (!pDev->ackPlain)
+					{
+						while (pCtx->cmdIdx < pCtx->cmdLen)
+						{
+							EBS_txCmdDone(pDev, &pCtx->cmd[pCtx->cmdIdx]);
+							pCtx->cmdIdx += ETX_CMD_LEN;
+						}
+						EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+					} else if (pCtx->cmdLen > 0)
+					{
+						EBS_updatePollState(pCtx, EBS_POLL_STATE_CMD);
+					} else
+					{
+						EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+					}
+				} else if (pCtx->pollState == EBS_POLL_STATE_CMD
+						&& index < scanRes)
+				{
+					EBS_txCmdDone(&discTxList[index], &pCtx->cmd[pCtx->cmdIdx]);
+
+					// One command per write, send the next one if any
+					pCtx->cmdIdx += ETX_CMD_LEN;
+					if (pCtx->cmdIdx < pCtx->cmdLen)
+					{
+						EBS_updatePollState(pCtx, EBS_POLL_STATE_CMD);
+					} else
+					{
+						EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+					}
+				} else
+				{
+					EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+				}
 			}
 
-			procedureInProgress = FALSE;
+			pCtx->procedureInProgress = FALSE;
 		} else if (pMsg->method == ATT_FLOW_CTRL_VIOLATED_EVENT)
 		{
 			// ATT request-response or indication-confirmation flow control is
@@ -871,14 +1120,17 @@ static void EBS_processGATTMsg(gattMsgEvent_t *pMsg) {
 			// The app is informed in case it wants to drop the connection.
 
 			// Display the opcode of the message that caused the violation.
-			uout1("FC Violated: %d", pMsg->msg.flowCtrlEvt.opcode);
+			ulog1(WARN, "FC Violated: %d", pMsg->msg.flowCtrlEvt.opcode);
+
+			// Nothing more gets through, drop the link
+			EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
 		} else if (pMsg->method == ATT_MTU_UPDATED_EVENT)
 		{
 			// MTU size updated
 			uout1("MTU Size: %d", pMsg->msg.mtuEvt.MTU);
-		} else if (discState != EBS_DISC_STATE_IDLE)
+		} else if (pCtx->discState != EBS_DISC_STATE_IDLE)
 		{
-			EBS_processGATTDiscEvent(pMsg);
+			EBS_processGATTDiscEvent(pCtx, pMsg);
 		}
 	} // else - in case a GATT message came after a connection has dropped, ignore it.
 
@@ -900,10 +1152,19 @@ static void EBS_processCmdCompleteEvt(hciEvt_CmdComplete_t *pMsg) {
 	{
 		case HCI_READ_RSSI:
 		{
-			if (ebsState == EBS_STATE_POLLING)
+			EbsConnCtx_t *pCtx = EBS_Conn_find(
+					BUILD_UINT16(pMsg->pReturnParam[1], pMsg->pReturnParam[2]));
+
+			if (pMsg->pReturnParam[0] == SUCCESS && pCtx != NULL)
 			{
 				int8 rssi = (int8) pMsg->pReturnParam[3];
-				uout1("RSSI -dB: %d", (uint32_t )(-rssi));
+
+				EBS_RssiStat_add(&pCtx->rssiStat, rssi);
+				if (pCtx->target.rosterIdx < scanRes)
+				{
+					EBS_RssiStat_add(
+							&discTxList[pCtx->target.rosterIdx].rssiStat, rssi);
+				}
 			}
 		}
 			break;
@@ -931,7 +1192,7 @@ static void EBS_processPairState(uint8_t pairState, uint8_t status) {
 			uout0("Pairing success");
 		} else
 		{
-			uout1("Pairing fail: %d", status);
+			ulog1(WARN, "Pairing fail: %d", status);
 		}
 	} else if (pairState == GAPBOND_PAIRING_STATE_BONDED)
 	{
@@ -946,7 +1207,7 @@ static void EBS_processPairState(uint8_t pairState, uint8_t status) {
 			uout0("Bond save succ");
 		} else
 		{
-			uout1("Bond save fail: %d", status);
+			ulog1(WARN, "Bond save fail: %d", status);
 		}
 	}
 }
@@ -983,18 +1244,19 @@ static void EBS_processPasscode(uint16_t connectionHandle,
  *
  * @return  none
  */
-static void EBS_startDiscovery(void) {
+static void EBS_startDiscovery(EbsConnCtx_t *pCtx) {
 	attExchangeMTUReq_t req;
 
 	// Initialize cached handles
-	svcStartHdl = svcEndHdl = 0;
-	memset(charHdl, 0x00, 4);
-	discState = EBS_DISC_STATE_SVC;
+	pCtx->svcStartHdl = pCtx->svcEndHdl = 0;
+	memset(pCtx->charHdl, 0x00, sizeof(pCtx->charHdl));
+	pCtx->profileCounter = 0;
+	pCtx->discState = EBS_DISC_STATE_SVC;
 
 	// Discovery simple BLE service
 	uint8_t uuid[ATT_BT_UUID_SIZE] = { LO_UINT16(EVRSPROFILE_SERV_UUID),
 			HI_UINT16(EVRSPROFILE_SERV_UUID) };
-	VOID GATT_DiscPrimaryServiceByUUID(pConnectingSlot->connHdl, uuid,
+	VOID GATT_DiscPrimaryServiceByUUID(pCtx->connHdl, uuid,
 			ATT_BT_UUID_SIZE, selfEntity);
 
 	// Discover GATT Server's Rx MTU size
@@ -1012,16 +1274,16 @@ static void EBS_startDiscovery(void) {
  *
  * @return  none
  */
-static void EBS_processGATTDiscEvent(gattMsgEvent_t *pMsg) {
-	if (discState == EBS_DISC_STATE_SVC)
+static void EBS_processGATTDiscEvent(EbsConnCtx_t *pCtx, gattMsgEvent_t *pMsg) {
+	if (pCtx->discState == EBS_DISC_STATE_SVC)
 	{
 		// Service found, store handles
 		if (pMsg->method == ATT_FIND_BY_TYPE_VALUE_RSP
 				&& pMsg->msg.findByTypeValueRsp.numInfo > 0)
 		{
-			svcStartHdl = ATT_ATTR_HANDLE(
+			pCtx->svcStartHdl = ATT_ATTR_HANDLE(
 					pMsg->msg.findByTypeValueRsp.pHandlesInfo, 0);
-			svcEndHdl = ATT_GRP_END_HANDLE(
+			pCtx->svcEndHdl = ATT_GRP_END_HANDLE(
 					pMsg->msg.findByTypeValueRsp.pHandlesInfo, 0);
 
 		}
@@ -1031,15 +1293,22 @@ static void EBS_processGATTDiscEvent(gattMsgEvent_t *pMsg) {
 				&& (pMsg->hdr.status == bleProcedureComplete))
 				|| (pMsg->method == ATT_ERROR_RSP))
 		{
-			if (svcStartHdl != 0)
+			if (pCtx->svcStartHdl != 0
+					&& GATT_DiscAllChars(pCtx->connHdl, pCtx->svcStartHdl,
+							pCtx->svcEndHdl, selfEntity) == SUCCESS)
 			{
 				// Discover characteristic
-				VOID GATT_DiscAllChars(pConnectingSlot->connHdl, svcStartHdl, svcEndHdl,
-					selfEntity);
-				discState = EBS_DISC_STATE_CHAR;
+				pCtx->discState = EBS_DISC_STATE_CHAR;
+			} else
+			{
+				// Not an EVRS Tx, or discovery could not go on
+				ulog0(WARN, "Service not found");
+				pCtx->discState = EBS_DISC_STATE_IDLE;
+				pCtx->procedureInProgress = FALSE;
+				EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
 			}
 		}
-	} else if (discState == EBS_DISC_STATE_CHAR)
+	} else if (pCtx->discState == EBS_DISC_STATE_CHAR)
 	{
 		// Characteristic found, store handle
 		if ((pMsg->method == ATT_READ_BY_TYPE_RSP)
@@ -1050,31 +1319,31 @@ static void EBS_processGATTDiscEvent(gattMsgEvent_t *pMsg) {
 				switch(*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 5))
 				{
 					case LO_UINT16(EVRSPROFILE_SYSID_UUID):
-						charHdl[EVRSPROFILE_SYSID] = BUILD_UINT16(
+						pCtx->charHdl[EVRSPROFILE_SYSID] = BUILD_UINT16(
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 3),
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 4));
-						profileCounter++;
+						pCtx->profileCounter++;
 						break;
 
 					case LO_UINT16(EVRSPROFILE_DEVID_UUID):
-						charHdl[EVRSPROFILE_DEVID] = BUILD_UINT16(
+						pCtx->charHdl[EVRSPROFILE_DEVID] = BUILD_UINT16(
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 3),
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 4));
-						profileCounter++;
+						pCtx->profileCounter++;
 						break;
 
 					case LO_UINT16(EVRSPROFILE_CMD_UUID):
-						charHdl[EVRSPROFILE_CMD] = BUILD_UINT16(
+						pCtx->charHdl[EVRSPROFILE_CMD] = BUILD_UINT16(
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 3),
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 4));
-						profileCounter++;
+						pCtx->profileCounter++;
 						break;
 
 					case LO_UINT16(EVRSPROFILE_DATA_UUID):
-						charHdl[EVRSPROFILE_DATA] = BUILD_UINT16(
+						pCtx->charHdl[EVRSPROFILE_DATA] = BUILD_UINT16(
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 3),
 								*(pMsg->msg.readByTypeRsp.pDataList + counter*7 + 4));
-						profileCounter++;
+						pCtx->profileCounter++;
 						break;
 				}
 			}
@@ -1082,188 +1351,183 @@ static void EBS_processGATTDiscEvent(gattMsgEvent_t *pMsg) {
 				&& (pMsg->hdr.status == bleProcedureComplete)
 				|| (pMsg->method == ATT_ERROR_RSP))
 		{
-			uout1("%d Profile(s) Found ", profileCounter);
-			procedureInProgress = FALSE;
-			discState = EBS_DISC_STATE_IDLE;
-			EBS_updatePollState(0, EBS_POLL_STATE_READ);
+			uout1("%d Profile(s) Found ", pCtx->profileCounter);
+			pCtx->procedureInProgress = FALSE;
+			pCtx->discState = EBS_DISC_STATE_IDLE;
+			EBS_updatePollState(pCtx, EBS_POLL_STATE_READ);
 		}
 
 	}
 }
 
 /*********************************************************************
- * @fn      EBS_findSvcUuid
+ * @fn      EBS_discoverDevices
  *
- * @brief   Find a given UUID in an advertiser's service UUID list.
+ * @brief   Scan to discover devices.
  *
- * @return  TRUE if service UUID found
+ * @return  none
  */
-static bool EBS_findSvcUuid(uint16_t uuid, uint8_t *pData,
-		uint8_t dataLen) {
-	uint8_t adLen;
-	uint8_t adType;
-	uint8_t *pEnd;
+static void EBS_discoverDevices(void) {
+	if (!scanningStarted)
+	{
+		//Clear old scan results
+		scanRes = 0;
+		memset(discTxList, NULL, sizeof(discTxList[0]) * MAX_SCAN_RES);
+		pollQueueHead = 0;
+		pollQueueCount = 0;
 
-	pEnd = pData + dataLen - 1;
+		// Votes are kept by roster index
+		EBS_Tally_reset(voteEpoch);
 
-	// While end of data not reached
-	while (pData < pEnd)
+		uout0("Discovering...");
+		EBS_startScan(scanDuration);
+	} else
 	{
-		// Get length of next AD item
-		adLen = *pData++;
-		if (adLen > 0)
-		{
-			adType = *pData;
-
-			// If AD type is for 16-bit service UUID
-			if ((adType == GAP_ADTYPE_16BIT_MORE)
-					|| (adType == GAP_ADTYPE_16BIT_COMPLETE))
-			{
-				pData++;
-				adLen--;
+		GAPCentralRole_CancelDiscovery();
+	}
+}
 
-				// For each UUID in list
-				while (adLen >= 2 && pData < pEnd)
-				{
-					// Check for match
-					if ((pData[0] == LO_UINT16(uuid))
-							&& (pData[1] == HI_UINT16(uuid)))
-					{
-						// Match found
-						return TRUE;
-					}
+/*********************************************************************
+ * @fn      EBS_startScan
+ *
+ * @brief   Start a scan period, with a low duty cycle if a link is up.
+ *
+ * @param   duration - scan period in ms
+ *
+ * @return  none
+ */
+static void EBS_startScan(uint16_t duration) {
+	scanningStarted = TRUE;
 
-					// Go to next AD item
-					pData += 2;
-					adLen -= 2;
-				}
+	GAP_SetParamValue(TGAP_GEN_DISC_SCAN, duration);
+	GAP_SetParamValue(TGAP_LIM_DISC_SCAN, duration);
 
-				// Handle possible erroneous extra byte in UUID list
-				if (adLen == 1)
-				{
-					pData++;
-				}
+	if (linkDB_NumActive() > 0)
+	{
+		GAP_SetParamValue(TGAP_GEN_DISC_SCAN_INT, LINK_SCAN_INTERVAL);
+		GAP_SetParamValue(TGAP_GEN_DISC_SCAN_WIND, LINK_SCAN_WINDOW);
+	} else
+	{
+		GAP_SetParamValue(TGAP_GEN_DISC_SCAN_INT, scanInterval);
+		GAP_SetParamValue(TGAP_GEN_DISC_SCAN_WIND, scanWindow);
+	}
 
-			} else
-			{
-				// Go to next AD item
-				pData += adLen;
-			}
-		}
+	if (GAPCentralRole_StartDiscovery(DEFAULT_DISCOVERY_MODE,
+			DEFAULT_DISCOVERY_ACTIVE_SCAN,
+			DEFAULT_DISCOVERY_WHITE_LIST) != SUCCESS)
+	{
+		scanningStarted = FALSE;
 	}
-	// Match not found
-	return FALSE;
 }
 
 /*********************************************************************
- * @fn      EBS_discoverDevices
+ * @fn      EBS_resumeScan
  *
- * @brief   Scan to discover devices.
+ * @brief   Keep scanning while polling. The scan is not restarted while
+ *          a link is being established, the controller cannot scan and
+ *          initiate at the same time.
  *
  * @return  none
  */
-static void EBS_discoverDevices(void) {
-	if (!scanningStarted)
-	{
-		scanningStarted = TRUE;
-
-		//Clear old scan results
-		scanRes = 0;
-		memset(discTxList, NULL, sizeof(discTxList[0]) * MAX_SCAN_RES);
-
-		uout0("Discovering...");
-		GAPCentralRole_StartDiscovery(DEFAULT_DISCOVERY_MODE,
-		DEFAULT_DISCOVERY_ACTIVE_SCAN,
-		DEFAULT_DISCOVERY_WHITE_LIST);
-	} else
+static void EBS_resumeScan(void) {
+	if (ebsState != EBS_STATE_POLLING || scanningStarted
+			|| EBS_Conn_pending() != NULL)
 	{
-		GAPCentralRole_CancelDiscovery();
+		return;
 	}
+
+	EBS_startScan(DEFAULT_RESCAN_DURATION);
 }
 
 /**********************************************************************
  * @fn      EBS_timeoutConnecting
  *
- * @brief   Post event if connecting is timed out.
+ * @brief   Cancel the pending link establishment on timeout.
  *
  * @return  none
  */
-Void EBS_timeoutConnecting(UArg arg0) {
-	if (pConnectingSlot != NULL)
+static void EBS_timeoutConnecting(UArg arg0) {
+	if (EBS_Conn_pending() != NULL)
 	{
-		EBS_enqueueMsg(EBS_CONNECTING_TIMEOUT_EVT, 0, NULL);
+		GAPCentralRole_TerminateLink(GAP_CONNHANDLE_INIT);
 	}
 }
 
 
-static bool EBS_checkBSId(uint8_t bsID, uint8_t *pEvtData, uint8_t dataLen) {
-	uint8_t adLen;
-	uint8_t adType;
-	uint8_t *pEnd;
-
-	int ii = 0;
+/*********************************************************************
+ * @fn      EBS_findDeviceInfo
+ *
+ * @brief   Find a device in the device discovery result list
+ *
+ * @return  index in discTxList, EBS_ROSTER_IDX_NONE if not found
+ */
+static uint8_t EBS_findDeviceInfo(uint8_t *pAddr) {
+	uint8_t i;
 
-	pEnd = pEvtData + dataLen - 1;
-
-	//Display_print5(dispHdl, 9, 0,"len %d, 0x%02x, 0x%02x, 0x%02x, 0x%02x",
-	//		dataLen,pEvtData[8],pEvtData[9],pEvtData[10],pEvtData[11]);
-	// While end of data not reached
-	while (pEvtData < pEnd)
+	for (i = 0; i < scanRes; i++)
 	{
-		// Get length of next data item
-		adLen = *pEvtData++;
-		if (adLen > 0)
+		if (memcmp(pAddr, discTxList[i].addr, B_ADDR_LEN) == 0)
 		{
-			adType = *pEvtData;
-			//Display_print1(dispHdl, ii+9, 0, "0x%02x",adType);
-			// If AD type is for local name
-			if (adType == ETX_ADTYPE_DEST)
-			{
-				pEvtData++;
-				// For base station identifier in the advert data
-				return (*pEvtData == bsID);
-			} else
-			{
-				// Go to next item
-				pEvtData += adLen;
-				ii++;
-			}
+			return i;
 		}
 	}
-	// No name found
-	return FALSE;
-}
 
+	return EBS_ROSTER_IDX_NONE;
+}
 
 /*********************************************************************
- * @fn      EBS_addDeviceInfo
+ * @fn      EBS_findDeviceByID
  *
- * @brief   Add a device to the device discovery result list
+ * @brief   Find a Tx in the device discovery result list by its ID
  *
- * @return  none
+ * @return  index in discTxList, EBS_ROSTER_IDX_NONE if not found
  */
-static void EBS_addDeviceInfo(uint8_t *pAddr, uint8_t addrType) {
+static uint8_t EBS_findDeviceByID(uint8_t *pTxDevID) {
 	uint8_t i;
 
-	// If result count not at max
-	if (scanRes < MAX_SCAN_RES)
+	for (i = 0; i < scanRes; i++)
 	{
-		// Check if device is already in scan results
-		for (i = 0; i < scanRes; i++)
+		if (memcmp(pTxDevID, discTxList[i].txDevID, ETX_DEVID_LEN) == 0)
 		{
-			if (memcmp(pAddr, discTxList[i].addr, B_ADDR_LEN) == 0)
-			{
-				return;
-			}
+			return i;
 		}
+	}
+
+	return EBS_ROSTER_IDX_NONE;
+}
+
+/*********************************************************************
+ * @fn      EBS_addDeviceInfo
+ *
+ * @brief   Add a device to the device discovery result list
+ *
+ * @return  index in discTxList, EBS_ROSTER_IDX_NONE if the list is full
+ */
+static uint8_t EBS_addDeviceInfo(uint8_t *pAddr, uint8_t addrType) {
+	uint8_t index = EBS_findDeviceInfo(pAddr);
 
+	// If not in scan results and result count not at max
+	if (index == EBS_ROSTER_IDX_NONE && scanRes < MAX_SCAN_RES)
+	{
 		// Add addr to scan result list
-		memcpy(discTxList[scanRes].addr, pAddr, B_ADDR_LEN);
-		discTxList[scanRes].addrType = addrType;
+		index = scanRes;
+		memcpy(discTxList[index].addr, pAddr, B_ADDR_LEN);
+		discTxList[index].addrType = addrType;
+		discTxList[index].acked = FALSE;
+		discTxList[index].queued = FALSE;
+		discTxList[index].linked = FALSE;
+		EBS_RssiStat_reset(&discTxList[index].rssiStat);
+		discTxList[index].txPower = EBS_TXPWR_UNKNOWN;
+		discTxList[index].txEpoch = voteEpoch;
 
 		// Increment scan result count
 		scanRes++;
+
+		// Never polled, poll it once whatever its data version
+		EBS_queuePoll(index);
 	}
+
+	return index;
 }
 
 /*********************************************************************
@@ -1318,44 +1582,52 @@ static bool EBS_findLocalName(uint8_t *pEvtData, uint8_t dataLen) {
 }
 */
 /*********************************************************************
- * @fn      EBS_addDeviceName
+ * @fn      EBS_processAdvRec
  *
- * @brief   Add a name to an existing device in the scan result list
+ * @brief   Apply a decoded advert report to the scan result list
+ *
+ * @param   pRec - decoded advert report
  *
  * @return  none
  */
-static void EBS_addDeviceID(uint8_t index, uint8_t *pEvtData,
-		uint8_t dataLen) {
-	uint8_t scanRspLen;
-	uint8_t scanRspType;
-	uint8_t *pEnd;
+static void EBS_processAdvRec(EbsAdvRec_t *pRec) {
+	uint8_t index;
 
-	pEnd = pEvtData + dataLen - 1;
+	//Add tx device found by UUID and base station ID
+	if (pRec->flags & EBS_ADV_FLAG_TARGET)
+	{
+		index = EBS_addDeviceInfo(pRec->addr, pRec->addrType);
+	} else
+	{
+		index = EBS_findDeviceInfo(pRec->addr);
+	}
 
-	// While end of data not reached
-	while (pEvtData < pEnd)
+	// Only devices already in scan results are updated
+	if (index == EBS_ROSTER_IDX_NONE)
 	{
-		// Get length of next scan response item
-		scanRspLen = *pEvtData++;
-		if (scanRspLen > 0)
-		{
-			scanRspType = *pEvtData;
+		return;
+	}
 
-			// If scan response type is for local name
-			if (scanRspType == ETX_ADTYPE_DEVID)
-			{
-				//Set name length in the device struct.
-				pEvtData++;
+	if (pRec->flags & EBS_ADV_FLAG_DEVID)
+	{
+		memcpy(discTxList[index].txDevID, pRec->txDevID, ETX_DEVID_LEN);
+	}
 
-				//Copy device id from the scan response data
-				for (int j = 0; j < ETX_DEVID_LEN; j++)
-					discTxList[index].txDevID[j] = *pEvtData++;
-			}
-		} else
-		{
-			// Go to next scan response item
-			pEvtData += scanRspLen;
-		}
+	// Samples taken at another output power no longer apply
+	if ((pRec->flags & EBS_ADV_FLAG_TXPWR)
+			&& pRec->txPower != discTxList[index].txPower)
+	{
+		discTxList[index].txPower = pRec->txPower;
+		EBS_RssiStat_reset(&discTxList[index].rssiStat);
+	}
+
+	EBS_RssiStat_add(&discTxList[index].rssiStat, pRec->rssi);
+
+	// Queue the Tx for polling if it voted since its last acknowledged poll
+	if (pRec->flags & EBS_ADV_FLAG_DVER)
+	{
+		discTxList[index].dataVer = pRec->dataVer;
+		EBS_queuePoll(index);
 	}
 }
 
@@ -1369,6 +1641,22 @@ static void EBS_addDeviceID(uint8_t index, uint8_t *pEvtData,
  * @return  TRUE if safe to deallocate event message, FALSE otherwise.
  */
 static uint8_t EBS_eventCB(gapCentralRoleEvent_t *pEvent) {
+	// Decode advert reports in place and batch them for the application,
+	// only the first report of a batch wakes the application task
+	if (pEvent->gap.opcode == GAP_DEVICE_INFO_EVENT)
+	{
+		EbsAdvRec_t rec;
+
+		if (EBS_AdvRpt_decode(&pEvent->deviceInfo, baseStationID, &rec)
+				&& EBS_AdvRpt_push(&rec))
+		{
+			Semaphore_post(sem);
+		}
+
+		// Nothing in the event is referenced after decoding
+		return TRUE;
+	}
+
 	// Forward the role event to the application
 	if (EBS_enqueueMsg(EBS_STACK_MSG_EVT, SUCCESS, (uint8_t *) pEvent))
 	{
@@ -1426,16 +1714,52 @@ static void EBS_passcodeCB(uint8_t *deviceAddr,
 /*********************************************************************
  * @fn      EBS_startDiscHandler
  *
- * @brief   Clock handler function
+ * @brief   Service discovery delay timer handler
  *
- * @param   a0 - ignored
+ * @param   a0 - connection handle
+ *
+ * @return  none
+ */
+static void EBS_startDiscHandler(UArg a0) {
+	EbsConnCtx_t *pCtx = EBS_Conn_find(a0);
+
+	// Link may have dropped since the delay was armed
+	if (pCtx != NULL)
+	{
+		EBS_startDiscovery(pCtx);
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_pollTimeoutHandler
+ *
+ * @brief   Poll watchdog handler. The poll did not finish in time, a
+ *          response never came, drop the link so the slot frees up.
+ *
+ * @param   a0 - connection handle
  *
  * @return  none
  */
-void EBS_startDiscHandler(UArg a0) {
-	events |= EBS_START_DISCOVERY_EVT;
+static void EBS_pollTimeoutHandler(UArg a0) {
+	EbsConnCtx_t *pCtx = EBS_Conn_find(a0);
+
+	if (pCtx != NULL)
+	{
+		ulog1(WARN, "Poll timeout, state %d", pCtx->pollState);
+		pCtx->pollState = EBS_POLL_STATE_TERMINATE;
+		GAPCentralRole_TerminateLink(pCtx->connHdl);
+	}
+}
 
-	// Wake up the application thread when it waits for clock event
+/*********************************************************************
+ * @fn      EBS_timerWakeHandler
+ *
+ * @brief   App timer wheel clock handler, wakes the app task to fire
+ *          the due timers.
+ *
+ * @return  none
+ */
+static void EBS_timerWakeHandler(void) {
 	Semaphore_post(sem);
 }
 
@@ -1470,185 +1794,1162 @@ uint8_t EBS_enqueueMsg(uint8_t event, uint8_t status,
 	// Create dynamic pointer to message.
 	if (pMsg)
 	{
+		EbsLane_t lane = EBS_LANE_LOW;
+
 		pMsg->hdr.event = event;
 		pMsg->hdr.state = status;
 		pMsg->pData = pData;
 
-		// Enqueue the message.
-		return Util_enqueueMsg(appMsgQueue, sem, (uint8_t *) pMsg);
+		// Link, pairing and state events must not wait behind user input
+		if (event != EBS_KEY_CHANGE_EVT)
+		{
+			lane = EBS_LANE_HIGH;
+		}
+
+		// Enqueue the message, a full lane sheds it
+		if (Board_MsgQ_enqueue(&appLanes[lane], sem, (uint8_t *) pMsg))
+		{
+			return TRUE;
+		}
+		ICall_free(pMsg);
 	}
 	return FALSE;
 }
 
-static uint32_t EBS_parseDevID(uint8_t* devID) {
-	return BUILD_UINT32(devID[0], devID[1], devID[2], devID[3]);
+/*********************************************************************
+ * @fn      EBS_isCongested
+ *
+ * @brief   Check whether app messages are backing up, optional work
+ *          such as RSSI reads should be skipped while they are.
+ *
+ * @return  TRUE if any lane is at least half full
+ */
+bool EBS_isCongested(void) {
+	return (appLanes[EBS_LANE_HIGH].stats.depth >= EBS_HIGH_LANE_DEPTH / 2)
+			|| (appLanes[EBS_LANE_LOW].stats.depth >= EBS_LOW_LANE_DEPTH / 2);
 }
 
-static uint8_t EBS_writeCharbyHandle(uint16_t connHandle, ProfileId_t charHdlId,
-		uint8_t* pData, uint8_t len) {
-	if (len > 23)
-		return FAILURE;
-	// Do a write using char handle
-	attWriteReq_t req;
-	uint8_t status;
-	req.pValue = GATT_bm_alloc(connHandle, ATT_WRITE_REQ, len, NULL);
-	if (req.pValue != NULL)
-	{
-		req.handle = charHdl[charHdlId];
-		req.len = len;
-		//memcpy(req.pValue, pData, len);
-		for (int i = 0; i < len; i++)
-			req.pValue[i] = pData[i];
-		req.sig = 0;
-		req.cmd = 0;
-		status = GATT_WriteCharValue(connHandle, &req, selfEntity);
-		//Display_print2(dispHandle,ROW_SIX,0,"Write req sent [%d,0x%02x]", req.len, *(req.pValue));
-		if (status != SUCCESS)
-			GATT_bm_free((gattMsg_t *) &req, ATT_WRITE_REQ);
-	} else
+/*********************************************************************
+ * @fn      EBS_reportQueueStats
+ *
+ * @brief   Queue report timer handler. Sends one frame with, for each
+ *          app lane, the depth, high-water mark and drops, then the
+ *          advert ring high-water mark, drops and merges, then the
+ *          skipped RSSI ticks, the duplicate and the stale votes dropped.
+ *          Counters are little endian.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_reportQueueStats(UArg a0) {
+	uint8_t buf[EBS_NUM_LANES * 6 + 21];
+	uint8_t len = 0;
+	EbsAdvRptStats_t advStats;
+	uint32_t skips;
+	uint32_t dups;
+	uint8_t lane;
+
+	for (lane = 0; lane < EBS_NUM_LANES; lane++)
 	{
-		status = bleMemAllocError;
+		boardMsgLaneStats_t stats;
+
+		Board_MsgQ_getStats(&appLanes[lane], &stats);
+		buf[len++] = (uint8_t) stats.depth;
+		buf[len++] = (uint8_t) stats.highWater;
+		buf[len++] = BREAK_UINT32(stats.drops, 0);
+		buf[len++] = BREAK_UINT32(stats.drops, 1);
+		buf[len++] = BREAK_UINT32(stats.drops, 2);
+		buf[len++] = BREAK_UINT32(stats.drops, 3);
 	}
-	return status;
-}
 
-static uint8_t EBS_readCharbyHandle(uint16_t connHandle, ProfileId_t charHdlId) {
-	// Do a read
-	attReadReq_t req;
-	uint8_t status;
-	req.handle = charHdl[charHdlId];
-	status = GATT_ReadCharValue(connHandle, &req, selfEntity);
-	return status;
+	EBS_AdvRpt_getStats(&advStats);
+	buf[len++] = advStats.highWater;
+	buf[len++] = BREAK_UINT32(advStats.drops, 0);
+	buf[len++] = BREAK_UINT32(advStats.drops, 1);
+	buf[len++] = BREAK_UINT32(advStats.drops, 2);
+	buf[len++] = BREAK_UINT32(advStats.drops, 3);
+	buf[len++] = BREAK_UINT32(advStats.merges, 0);
+	buf[len++] = BREAK_UINT32(advStats.merges, 1);
+	buf[len++] = BREAK_UINT32(advStats.merges, 2);
+	buf[len++] = BREAK_UINT32(advStats.merges, 3);
+
+	skips = EBS_RssiSkipped();
+	buf[len++] = BREAK_UINT32(skips, 0);
+	buf[len++] = BREAK_UINT32(skips, 1);
+	buf[len++] = BREAK_UINT32(skips, 2);
+	buf[len++] = BREAK_UINT32(skips, 3);
+
+	dups = EBS_Vote_dups();
+	buf[len++] = BREAK_UINT32(dups, 0);
+	buf[len++] = BREAK_UINT32(dups, 1);
+	buf[len++] = BREAK_UINT32(dups, 2);
+	buf[len++] = BREAK_UINT32(dups, 3);
+	buf[len++] = BREAK_UINT32(staleVotes, 0);
+	buf[len++] = BREAK_UINT32(staleVotes, 1);
+	buf[len++] = BREAK_UINT32(staleVotes, 2);
+	buf[len++] = BREAK_UINT32(staleVotes, 3);
+
+	Board_Display_Frame(EBS_FRAME_QUEUE_STATS, buf, len);
 }
 
+/*********************************************************************
+ * @fn      EBS_reportTelemetry
+ *
+ * @brief   Telemetry timer handler, also run on request. Sends one
+ *          frame with the app and idle task stacks, the ICall heap, the
+ *          depth and high-water mark of each app lane, the advert ring
+ *          high-water mark, the roster size and the poll queue depth.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_reportTelemetry(UArg a0) {
+	uint8_t buf[2 * BOARD_TELEMETRY_TASK_LEN + BOARD_TELEMETRY_HEAP_LEN
+			+ 2 * EBS_NUM_LANES + 3];
+	uint8_t len = 0;
+	boardTaskMem_t taskMem;
+	boardHeapMem_t heapMem;
+	EbsAdvRptStats_t advStats;
+	uint8_t lane;
+
+	Board_Telemetry_task(Task_handle(&ebsTask), &taskMem);
+	len += Board_Telemetry_packTask(&taskMem, &buf[len]);
+	Board_Telemetry_task(Task_getIdleTask(), &taskMem);
+	len += Board_Telemetry_packTask(&taskMem, &buf[len]);
+
+	Board_Telemetry_heap(&heapMem);
+	len += Board_Telemetry_packHeap(&heapMem, &buf[len]);
+
+	for (lane = 0; lane < EBS_NUM_LANES; lane++)
+	{
+		boardMsgLaneStats_t stats;
+
+		Board_MsgQ_getStats(&appLanes[lane], &stats);
+		buf[len++] = (uint8_t) stats.depth;
+		buf[len++] = (uint8_t) stats.highWater;
+	}
 
-static void EBS_updateEbsState(EbsState_t newState) {
-	ebsState = newState;
-	EBS_enqueueMsg(EBS_STATE_CHANGE_EVT, newState, NULL);
+	EBS_AdvRpt_getStats(&advStats);
+	buf[len++] = advStats.highWater;
+	buf[len++] = scanRes;
+	buf[len++] = pollQueueCount;
+
+	Board_Display_Frame(EBS_FRAME_TELEMETRY, buf, len);
 }
 
-static void EBS_stateChange(EbsState_t newState) {
-	switch (newState) {
-		case EBS_STATE_INIT:
-			uout0("ebsState = EBS_STATE_INIT");
+/*********************************************************************
+ * @fn      EBS_reportLoad
+ *
+ * @brief   CPU load report timer handler. Sends one frame with the
+ *          window length in ms, then for each load slot the share of
+ *          the window in 1/1000, the calls and the longest call in us.
+ *          Values are little endian. Time outside every slot is idle
+ *          or other tasks.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_reportLoad(UArg a0) {
+	uint8_t buf[4 + EBS_NUM_LOAD_SLOTS * 6];
+	uint8_t len = 0;
+	boardLoadSlot_t slots[BOARD_LOAD_MAX_SLOTS];
+	uint32_t window = Board_Load_collect(slots);
+	uint32_t windowMs = window * Clock_tickPeriod / 1000;
+	uint8_t i;
 
-			break;
+	buf[len++] = BREAK_UINT32(windowMs, 0);
+	buf[len++] = BREAK_UINT32(windowMs, 1);
+	buf[len++] = BREAK_UINT32(windowMs, 2);
+	buf[len++] = BREAK_UINT32(windowMs, 3);
 
-		case EBS_STATE_DISCOVERY:
-			uout0("ebsState = EBS_STATE_DISCOVERY");
-			EBS_discoverDevices();
-			break;
+	for (i = 0; i < EBS_NUM_LOAD_SLOTS; i++)
+	{
+		uint32_t permille = window ? (uint64_t) slots[i].busy * 1000 / window : 0;
+		uint32_t maxUs = slots[i].maxCall * Clock_tickPeriod;
 
-		case EBS_STATE_UPLOAD:
-			//TODO: send the discTxList to BC using UART
-			uout0("ebsState = EBS_STATE_UPLOAD");
+		if (maxUs > 0xFFFF)
+		{
+			maxUs = 0xFFFF;
+		}
 
-			break;
+		buf[len++] = LO_UINT16(permille);
+		buf[len++] = HI_UINT16(permille);
+		buf[len++] = LO_UINT16(slots[i].calls);
+		buf[len++] = HI_UINT16(slots[i].calls);
+		buf[len++] = LO_UINT16(maxUs);
+		buf[len++] = HI_UINT16(maxUs);
+	}
 
-		case EBS_STATE_POLLING:
-			uout0("ebsState = EBS_STATE_POLLING");
-			Semaphore_post(targetConnSem); // enable target connect
+	Board_Display_Frame(EBS_FRAME_CPU_LOAD, buf, len);
+}
 
-			break;
+/*********************************************************************
+ * @fn      EBS_reportTally
+ *
+ * @brief   Tally timer handler, also run on request. Sends a snapshot
+ *          of the vote counts, see EBS_Tally_pack. The raw votes go
+ *          through evrs_bs_uplink on their own.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_reportTally(UArg a0) {
+	uint8_t buf[EBS_TALLY_PACKED_MAX];
 
-		default:
-			break;
-	}
+	Board_Display_Frame(EBS_FRAME_TALLY, buf, EBS_Tally_pack(buf));
 }
 
+/*********************************************************************
+ * @fn      EBS_uploadRoster
+ *
+ * @brief   Send the roster to the host, ROSTER_FRAME_MAX_TX entries per
+ *          frame. Each frame starts with the index of its first entry
+ *          and the roster size, an empty roster sends one frame.
+ *
+ * @return  none
+ */
+static void EBS_uploadRoster(void) {
+	// Static, too large for the task stack
+	static uint8_t buf[2 + ROSTER_FRAME_MAX_TX * ROSTER_ENTRY_LEN];
+	uint8_t first = 0;
+
+	do
+	{
+		uint8_t len = 0;
+		uint8_t i;
 
-static void EBS_updatePollState(uint8_t targetIndex, EbsPollState_t newState) {
-	if (ebsState != EBS_STATE_POLLING)
-		return;
-	targetList[targetIndex].state = newState;
-	uint8_t rsp = 0xFF;
-	switch (newState) {
-		case EBS_POLL_STATE_IDLE:
-			break;
+		buf[len++] = first;
+		buf[len++] = scanRes;
 
-		case EBS_POLL_STATE_CONNECT:
-			// TODO: need a lookup process if using parallel connections
-			Semaphore_pend(targetConnSem, -1); // waiting for a vacant conn slot
-			// findNextVacantSlot(pVacantSlot) // TODO: find a vacant target connection slot
-			pConnectingSlot = targetList + targetIndex;
-			Util_startClock(&connectingClock);
-			GAPCentralRole_EstablishLink(LINK_HIGH_DUTY_CYCLE, LINK_WHITE_LIST,
-					targetList[targetIndex].addrType, targetList[targetIndex].addr);
-			break;
+		for (i = first; i < scanRes && i < first + ROSTER_FRAME_MAX_TX; i++)
+		{
+			buf[len++] = discTxList[i].addrType;
+			memcpy(&buf[len], discTxList[i].addr, B_ADDR_LEN);
+			len += B_ADDR_LEN;
+			memcpy(&buf[len], discTxList[i].txDevID, ETX_DEVID_LEN);
+			len += ETX_DEVID_LEN;
+			buf[len++] = discTxList[i].dataVer;
+		}
 
-		case EBS_POLL_STATE_READ:
-			Semaphore_post(targetConnSem); // release the sem to allow next connect
-			pConnectingSlot = NULL;
-			EBS_readCharbyHandle(targetList[targetIndex].connHdl, EVRSPROFILE_DATA);
-			// TODO: upload the data to EBC
-			break;
+		Board_Display_Frame(EBS_FRAME_ROSTER, buf, len);
+		first = i;
+	} while (first < scanRes);
+}
 
-		case EBS_POLL_STATE_WRITE: // finish read
-			uout0("into write process");
-			EBS_writeCharbyHandle(targetList[targetIndex].connHdl, EVRSPROFILE_DATA, &rsp, 1);
+/*********************************************************************
+ * @fn      EBS_findReport
+ *
+ * @brief   Get the timer and handler of a periodic uplink report.
+ *
+ * @param   frameType - EBS_FRAME_* sent by the report
+ * @param   ppTimer - report timer
+ *
+ * @return  report handler, NULL if the frame is not a periodic report
+ */
+static boardTimerCB_t EBS_findReport(uint8_t frameType,
+		boardTimer_t **ppTimer) {
+	switch (frameType)
+	{
+		case EBS_FRAME_LINK_RSSI:
+		case EBS_FRAME_TX_RSSI:
+			*ppTimer = &rssiReportTmr;
+			return EBS_reportRssiStats;
 
-			break;
+		case EBS_FRAME_QUEUE_STATS:
+			*ppTimer = &queueReportTmr;
+			return EBS_reportQueueStats;
 
-		case EBS_POLL_STATE_TERMINATE: // finish write
-			GAPCentralRole_TerminateLink(targetList[targetIndex].connHdl);
-			break;
+		case EBS_FRAME_TELEMETRY:
+			*ppTimer = &telemetryTmr;
+			return EBS_reportTelemetry;
+
+		case EBS_FRAME_CPU_LOAD:
+			*ppTimer = &loadReportTmr;
+			return EBS_reportLoad;
+
+		case EBS_FRAME_TALLY:
+			*ppTimer = &tallyReportTmr;
+			return EBS_reportTally;
 
 		default:
-			break;
+			return NULL;
 	}
 }
 
 /*********************************************************************
- * @fn      EBS_handleKeys
+ * @fn      EBS_processHostCmd
  *
- * @brief   Handles all key events for this device.
+ * @brief   Carry out a host command and answer with EBS_FRAME_CMD_RSP.
  *
- * @param   shift - true if in shift/alt.
- * @param   keys - bit field for key events. Valid entries:
- *                 HAL_KEY_SW_2
- *                 HAL_KEY_SW_1
+ * @param   pCmd - [command, payload length, payload]
  *
  * @return  none
  */
-static void EBS_handleKeys(uint8_t shift, uint8_t keys) {
-	switch (ebsState) {
-		case EBS_STATE_INIT:
-			// TODO: pretend to receive a uart_ack
-			if (keys & KEY_RIGHT)
-				EBS_updateEbsState(EBS_STATE_DISCOVERY);
+static void EBS_processHostCmd(uint8_t *pCmd) {
+	uint8_t cmd = pCmd[0];
+	uint8_t len = pCmd[1];
+	uint8_t *pArg = &pCmd[2];
+	uint8_t status = EBS_Cmd_check(cmd, len);
+
+	if (status != EBS_CMD_STATUS_OK)
+	{
+		EBS_Cmd_respond(cmd, status);
+		return;
+	}
+
+	// Acknowledgements flow all the time, they get no response
+	if (cmd == EBS_CMD_ACK)
+	{
+		EBS_Uplink_ack(BUILD_UINT16(pArg[0], pArg[1]), pArg[2]);
+		return;
+	}
+
+	switch (cmd)
+	{
+		case EBS_CMD_START_DISC:
+			// A new discovery clears the roster, never while polling
+			if ((ebsState != EBS_STATE_INIT && ebsState != EBS_STATE_UPLOAD)
+					|| scanningStarted)
+			{
+				status = EBS_CMD_STATUS_BAD_STATE;
+				break;
+			}
+			EBS_updateEbsState(EBS_STATE_DISCOVERY);
 			break;
 
-		//case EBS_STATE_DISCOVERY:
-		case EBS_STATE_UPLOAD:
-			// TODO: pretend to receive a uart_ack
-			if (keys & KEY_LEFT) {
-				EBS_updateTargetList(discTxList[0].txDevID);
-				EBS_updateEbsState(EBS_STATE_POLLING);
+		case EBS_CMD_STOP_DISC:
+			// The end of the scan moves on to EBS_STATE_UPLOAD
+			if (ebsState != EBS_STATE_DISCOVERY || !scanningStarted)
+			{
+				status = EBS_CMD_STATUS_BAD_STATE;
+				break;
 			}
+			GAPCentralRole_CancelDiscovery();
 			break;
 
-		case EBS_STATE_POLLING:
-			if (keys & KEY_RIGHT) {
-				EBS_updatePollState(0,EBS_POLL_STATE_CONNECT);
-			} else if (keys & KEY_LEFT) {
-				EBS_updateTargetList(discTxList[1].txDevID);
-				EBS_updatePollState(0,EBS_POLL_STATE_CONNECT);
+		case EBS_CMD_START_POLL:
+			if (ebsState != EBS_STATE_DISCOVERY && ebsState != EBS_STATE_UPLOAD)
+			{
+				status = EBS_CMD_STATUS_BAD_STATE;
+				break;
 			}
+			EBS_updateEbsState(EBS_STATE_POLLING);
+			break;
 
-	}
-}
+		case EBS_CMD_LOAD_ROSTER:
+		{
+			uint8_t i;
 
+			for (i = 0; i < len; i += EBS_CMD_ROSTER_ENTRY_LEN)
+			{
+				uint8_t index = EBS_addDeviceInfo(&pArg[i + 1], pArg[i]);
 
-static void EBS_updateTargetList(uint8_t* txID) {
-	uint8_t index;
-	for (index = 0; index < scanRes; index++)
-		if (memcmp(discTxList[index].txDevID, txID, ETX_DEVID_LEN) == NULL)
+				if (index == EBS_ROSTER_IDX_NONE)
+				{
+					status = EBS_CMD_STATUS_FULL;
+					break;
+				}
+				memcpy(discTxList[index].txDevID, &pArg[i + 1 + B_ADDR_LEN],
+						ETX_DEVID_LEN);
+			}
+			break;
+		}
+
+		case EBS_CMD_POLL:
+		{
+			uint8_t i;
+
+			if (len == 0)
+			{
+				EBS_queueAllPolls();
+			}
+
+			for (i = 0; i < len; i += ETX_DEVID_LEN)
+			{
+				uint8_t index = EBS_findDeviceByID(&pArg[i]);
+
+				if (index == EBS_ROSTER_IDX_NONE)
+				{
+					status = EBS_CMD_STATUS_BAD_ARG;
+					continue;
+				}
+				discTxList[index].acked = FALSE;
+				EBS_queuePoll(index);
+			}
+
+			EBS_scheduleNextPoll();
+			break;
+		}
+
+		case EBS_CMD_SET_SCAN:
+		{
+			uint16_t interval = BUILD_UINT16(pArg[0], pArg[1]);
+			uint16_t window = BUILD_UINT16(pArg[2], pArg[3]);
+			uint16_t duration = BUILD_UINT16(pArg[4], pArg[5]);
+
+			// 2.5 ms to 10.24 s, the window fits in the interval
+			if (interval < 4 || interval > 0x4000 || window < 4
+					|| window > interval || duration == 0)
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+				break;
+			}
+
+			// Used from the next scan period on
+			scanInterval = interval;
+			scanWindow = window;
+			scanDuration = duration;
+			break;
+		}
+
+		case EBS_CMD_SET_CONN:
+		{
+			uint16_t minInt = BUILD_UINT16(pArg[0], pArg[1]);
+			uint16_t maxInt = BUILD_UINT16(pArg[2], pArg[3]);
+			uint16_t latency = BUILD_UINT16(pArg[4], pArg[5]);
+			uint16_t timeout = BUILD_UINT16(pArg[6], pArg[7]);
+
+			// 7.5 ms to 4 s intervals, 100 ms to 32 s supervision timeout,
+			// and the timeout has to cover the missed events latency
+			// allows twice over:
+			// timeout * 10 ms > (1 + latency) * maxInt * 1.25 ms * 2
+			if (minInt < 6 || maxInt > 3200 || minInt > maxInt
+					|| latency > 499 || timeout < 10 || timeout > 3200
+					|| (uint32_t) timeout * 4
+							<= (uint32_t) (1 + latency) * maxInt)
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+				break;
+			}
+
+			// Links stay up while scanning, see LINK_SCAN_WINDOW
+			if (minInt < LINK_MIN_CONN_INTERVAL)
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+				break;
+			}
+
+			// Used by the next link established
+			GAP_SetParamValue(TGAP_CONN_EST_INT_MIN, minInt);
+			GAP_SetParamValue(TGAP_CONN_EST_INT_MAX, maxInt);
+			GAP_SetParamValue(TGAP_CONN_EST_LATENCY, latency);
+			GAP_SetParamValue(TGAP_CONN_EST_SUPERV_TIMEOUT, timeout);
+			break;
+		}
+
+		case EBS_CMD_QUERY:
+		{
+			boardTimer_t *pTimer;
+			boardTimerCB_t pfnReport = EBS_findReport(pArg[0], &pTimer);
+
+			if (pArg[0] == EBS_FRAME_ROSTER)
+			{
+				EBS_uploadRoster();
+			} else if (pfnReport != NULL)
+			{
+				pfnReport(0);
+			} else
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+			}
+			break;
+		}
+
+		case EBS_CMD_SET_PERIOD:
+		{
+			boardTimer_t *pTimer;
+			boardTimerCB_t pfnReport = EBS_findReport(pArg[0], &pTimer);
+			uint16_t period = BUILD_UINT16(pArg[1], pArg[2]);
+
+			if (pfnReport == NULL)
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+				break;
+			}
+
+			Board_Timer_stop(pTimer);
+			if (period != 0)
+			{
+				Board_Timer_construct(pTimer, pfnReport, period, period, 0);
+				Board_Timer_start(pTimer);
+			}
+			break;
+		}
+
+		case EBS_CMD_SET_EPOCH:
+			EBS_setEpoch(pArg[0]);
+			break;
+
+		case EBS_CMD_BCAST:
+			// The stack may not be built to advertise
+			if (!EBS_Bcast_send(voteEpoch, pArg[0], pArg[1]))
+			{
+				status = EBS_CMD_STATUS_BAD_STATE;
+			}
+			break;
+
+		case EBS_CMD_SET_LOG:
+			// Levels above the build level are clamped to it
+			if (pArg[0] < BOARD_DISPLAY_LVL_ERR
+					|| pArg[0] > BOARD_DISPLAY_LVL_DEBUG)
+			{
+				status = EBS_CMD_STATUS_BAD_ARG;
+				break;
+			}
+			Board_Display_SetLevel(pArg[0]);
+			break;
+
+		default:
+			break;
+	}
+
+	EBS_Cmd_respond(cmd, status);
+}
+
+/*********************************************************************
+ * @fn      EBS_reportRssiStats
+ *
+ * @brief   RSSI report timer handler. Sends one frame with the
+ *          summaries of every open link and one with the summaries of
+ *          the next RSSI_REPORT_MAX_TX roster entries.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_reportRssiStats(UArg a0) {
+	uint8_t buf[RSSI_REPORT_MAX_TX * RSSI_REPORT_ENTRY_LEN];
+	uint8_t len = 0;
+	uint8_t i;
+
+	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+	{
+		EbsConnCtx_t *pCtx = EBS_Conn_find(i);
+
+		if (pCtx != NULL && pCtx->rssiStat.count > 0)
+		{
+			memcpy(&buf[len], pCtx->target.txDevID, ETX_DEVID_LEN);
+			len += ETX_DEVID_LEN;
+			len += EBS_RssiStat_pack(&pCtx->rssiStat, &buf[len]);
+		}
+	}
+	if (len)
+	{
+		Board_Display_Frame(EBS_FRAME_LINK_RSSI, buf, len);
+	}
+
+	// Walk the roster a few entries per report
+	len = 0;
+	for (i = 0; i < scanRes && len < sizeof(buf); i++)
+	{
+		if (rssiReportIdx >= scanRes)
+		{
+			rssiReportIdx = 0;
+		}
+
+		if (discTxList[rssiReportIdx].rssiStat.count > 0)
+		{
+			memcpy(&buf[len], discTxList[rssiReportIdx].txDevID, ETX_DEVID_LEN);
+			len += ETX_DEVID_LEN;
+			len += EBS_RssiStat_pack(&discTxList[rssiReportIdx].rssiStat,
+					&buf[len]);
+		}
+		rssiReportIdx++;
+	}
+	if (len)
+	{
+		Board_Display_Frame(EBS_FRAME_TX_RSSI, buf, len);
+	}
+}
+
+static uint32_t EBS_parseDevID(uint8_t* devID) {
+	return BUILD_UINT32(devID[0], devID[1], devID[2], devID[3]);
+}
+
+static uint8_t EBS_writeCharbyHandle(EbsConnCtx_t *pCtx, ProfileId_t charHdlId,
+		uint8_t* pData, uint8_t len) {
+	if (len > 23)
+		return FAILURE;
+	// Do a write using char handle
+	attWriteReq_t req;
+	uint8_t status;
+	uint16_t connHandle = pCtx->connHdl;
+	req.pValue = GATT_bm_alloc(connHandle, ATT_WRITE_REQ, len, NULL);
+	if (req.pValue != NULL)
+	{
+		req.handle = pCtx->charHdl[charHdlId];
+		req.len = len;
+		//memcpy(req.pValue, pData, len);
+		for (int i = 0; i < len; i++)
+			req.pValue[i] = pData[i];
+		req.sig = 0;
+		req.cmd = 0;
+		status = GATT_WriteCharValue(connHandle, &req, selfEntity);
+		//Display_print2(dispHandle,ROW_SIX,0,"Write req sent [%d,0x%02x]", req.len, *(req.pValue));
+		if (status != SUCCESS)
+			GATT_bm_free((gattMsg_t *) &req, ATT_WRITE_REQ);
+	} else
+	{
+		status = bleMemAllocError;
+	}
+	return status;
+}
+
+static uint8_t EBS_readCharbyHandle(EbsConnCtx_t *pCtx, ProfileId_t charHdlId) {
+	// Do a long read, the value lands in pCtx->data
+	attReadBlobReq_t req;
+	uint8_t status;
+	req.handle = pCtx->charHdl[charHdlId];
+	req.offset = 0;
+	pCtx->dataLen = 0;
+	status = GATT_ReadLongCharValue(pCtx->connHdl, &req, selfEntity);
+	return status;
+}
+
+
+static void EBS_updateEbsState(EbsState_t newState) {
+	ebsState = newState;
+	EBS_enqueueMsg(EBS_STATE_CHANGE_EVT, newState, NULL);
+}
+
+static void EBS_stateChange(EbsState_t newState) {
+	switch (newState) {
+		case EBS_STATE_INIT:
+			uout0("ebsState = EBS_STATE_INIT");
+
+			break;
+
+		case EBS_STATE_DISCOVERY:
+			uout0("ebsState = EBS_STATE_DISCOVERY");
+			EBS_discoverDevices();
+			break;
+
+		case EBS_STATE_UPLOAD:
+			uout0("ebsState = EBS_STATE_UPLOAD");
+			EBS_uploadRoster();
+
+			break;
+
+		case EBS_STATE_POLLING:
+			uout0("ebsState = EBS_STATE_POLLING");
+			EBS_scheduleNextPoll();
+			EBS_resumeScan();
+
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+static void EBS_updatePollState(EbsConnCtx_t *pCtx, EbsPollState_t newState) {
+	pCtx->pollState = newState;
+	switch (newState) {
+		case EBS_POLL_STATE_READ:
+			if (pCtx->target.rosterIdx < scanRes)
+			{
+				pCtx->pollVer = discTxList[pCtx->target.rosterIdx].dataVer;
+			}
+			if (EBS_readCharbyHandle(pCtx, EVRSPROFILE_DATA) != SUCCESS)
+			{
+				// No response will come, end the poll now
+				EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+			}
+			break;
+
+		case EBS_POLL_STATE_WRITE: // finish read
+		{
+			uint8_t ack[ETX_ACK_MAX_LEN];
+			uint8_t len = 1;
+
+			ulog0(DEBUG, "into write process");
+
+			// Acknowledge the vote read, with the commands for the Tx
+			// in the same write where it takes them
+			ack[0] = ETX_ACK_MARK;
+			pCtx->cmdLen = 0;
+			if (pCtx->target.rosterIdx < scanRes)
+			{
+				DevRecInfo_t *pDev = &discTxList[pCtx->target.rosterIdx];
+
+				pCtx->cmdLen = EBS_packTxCmds(pDev, pCtx->cmd);
+				if (!pDev->ackPlain)
+				{
+					ack[1] = LO_UINT16(pCtx->pollSeq);
+					ack[2] = HI_UINT16(pCtx->pollSeq);
+					memcpy(&ack[ETX_ACK_HDR_LEN], pCtx->cmd, pCtx->cmdLen);
+					len = ETX_ACK_HDR_LEN + pCtx->cmdLen;
+				}
+			}
+			if (EBS_writeCharbyHandle(pCtx, EVRSPROFILE_DATA, ack, len)
+					!= SUCCESS)
+			{
+				EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+			}
+		}
+			break;
+
+		case EBS_POLL_STATE_CMD: // finish write, command the Tx
+			if (EBS_writeCharbyHandle(pCtx, EVRSPROFILE_CMD,
+					&pCtx->cmd[pCtx->cmdIdx], ETX_CMD_LEN) != SUCCESS)
+			{
+				EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+			}
+			break;
+
+		case EBS_POLL_STATE_TERMINATE: // finish write
+			GAPCentralRole_TerminateLink(pCtx->connHdl);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_handleKeys
+ *
+ * @brief   Handles all key events for this device.
+ *
+ * @param   shift - true if in shift/alt.
+ * @param   keys - bit field for key events. Valid entries:
+ *                 HAL_KEY_SW_2
+ *                 HAL_KEY_SW_1
+ *
+ * @return  none
+ */
+static void EBS_handleKeys(uint8_t shift, uint8_t keys) {
+	// Both keys at once request a telemetry report in any state
+	if ((keys & (KEY_LEFT | KEY_RIGHT)) == (KEY_LEFT | KEY_RIGHT))
+	{
+		EBS_reportTelemetry(0);
+		return;
+	}
+
+	switch (ebsState) {
+		case EBS_STATE_INIT:
+			// Manual stand-in for EBS_CMD_START_DISC
+			if (keys & KEY_RIGHT)
+				EBS_updateEbsState(EBS_STATE_DISCOVERY);
+			break;
+
+		case EBS_STATE_DISCOVERY:
+			// Start polling without waiting for the scan to end,
+			// the scan keeps running
+			if (keys & KEY_LEFT) {
+				EBS_updateEbsState(EBS_STATE_POLLING);
+			}
+			break;
+
+		case EBS_STATE_UPLOAD:
+			// Manual stand-in for EBS_CMD_START_POLL
+			if (keys & KEY_LEFT) {
+				EBS_updateEbsState(EBS_STATE_POLLING);
+			}
+			break;
+
+		case EBS_STATE_POLLING:
+			if (keys & KEY_RIGHT) {
+				// Restart the scan if it stopped
+				EBS_resumeScan();
+			} else if (keys & KEY_LEFT) {
+				// Poll every Tx whatever its data version
+				EBS_queueAllPolls();
+				EBS_scheduleNextPoll();
+			}
+
+	}
+}
+
+
+/*********************************************************************
+ * @fn      EBS_connectTarget
+ *
+ * @brief   Establish a link to a Tx. Its context is opened when the
+ *          link is up.
+ *
+ * @param   index - index in discTxList
+ *
+ * @return  none
+ */
+static void EBS_connectTarget(uint8_t index) {
+	TargetInfo_t *pTarget = EBS_Conn_reserve(index);
+
+	if (pTarget == NULL)
+	{
+		return;
+	}
+
+	memcpy(pTarget->addr, discTxList[index].addr, B_ADDR_LEN);
+	memcpy(pTarget->txDevID, discTxList[index].txDevID, ETX_DEVID_LEN);
+	pTarget->addrType = discTxList[index].addrType;
+
+	if (GAPCentralRole_EstablishLink(LINK_HIGH_DUTY_CYCLE, LINK_WHITE_LIST,
+			pTarget->addrType, pTarget->addr) == SUCCESS)
+	{
+		discTxList[index].linked = TRUE;
+		Board_Timer_start(&connectingTmr);
+	} else
+	{
+		EBS_Conn_cancel();
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_pollDue
+ *
+ * @brief   Whether a Tx has to be polled: its data changed since its
+ *          last acknowledged poll, or it has not taken the current
+ *          epoch yet. A broadcast burst going out gets its chance to
+ *          deliver the epoch first.
+ *
+ * @param   pDev - roster entry of the Tx
+ *
+ * @return  TRUE if a poll is due
+ */
+static bool EBS_pollDue(DevRecInfo_t *pDev) {
+	return !(pDev->acked && pDev->dataVer == pDev->ackVer)
+			|| (pDev->txEpoch != voteEpoch && !EBS_Bcast_active());
+}
+
+/*********************************************************************
+ * @fn      EBS_queuePoll
+ *
+ * @brief   Queue a Tx for polling if a poll is due, see EBS_pollDue.
+ *
+ * @param   index - index in discTxList
+ *
+ * @return  none
+ */
+static void EBS_queuePoll(uint8_t index) {
+	DevRecInfo_t *pDev = &discTxList[index];
+
+	if (pDev->queued || !EBS_pollDue(pDev))
+	{
+		return;
+	}
+
+	pollQueue[(pollQueueHead + pollQueueCount) % MAX_SCAN_RES] = index;
+	pollQueueCount++;
+	pDev->queued = TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_queueAllPolls
+ *
+ * @brief   Forget every acknowledged data version and queue every Tx.
+ *
+ * @return  none
+ */
+static void EBS_queueAllPolls(void) {
+	uint8_t index;
+
+	for (index = 0; index < scanRes; index++)
+	{
+		discTxList[index].acked = FALSE;
+		EBS_queuePoll(index);
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_queueEpochPolls
+ *
+ * @brief   Queue every Tx not known to have taken the current epoch, the
+ *          poll acknowledgement carries it. Tx out of range are queued
+ *          again by their next advert until one poll gets through.
+ *
+ * @return  none
+ */
+static void EBS_queueEpochPolls(void) {
+	uint8_t index;
+
+	for (index = 0; index < scanRes; index++)
+	{
+		if (discTxList[index].txEpoch != voteEpoch)
+		{
+			EBS_queuePoll(index);
+		}
+	}
+	EBS_scheduleNextPoll();
+}
+
+/*********************************************************************
+ * @fn      EBS_takeData
+ *
+ * @brief   Take the votes of a DATA read, the journal oldest first and
+ *          the last vote after it, then acknowledge what was taken. The
+ *          first vote the host stream refuses stops the rest, they stay
+ *          at the Tx for a later poll.
+ *
+ * @param   pCtx - link the read came in on
+ *
+ * @return  none
+ */
+static void EBS_takeData(EbsConnCtx_t *pCtx) {
+	uint8_t *pData = pCtx->data;
+	uint8_t dataLen = pCtx->dataLen;
+	uint8_t recLen = (dataLen < ETX_DATA_LEN) ? dataLen : ETX_DATA_LEN;
+	uint8_t num = 0;
+	uint8_t taken = 0;
+	uint8_t i;
+
+	if (dataLen == 0)
+	{
+		// Nothing to forward, poll it again later
+		EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+		return;
+	}
+
+	// The Tx is told the current epoch once its data is acknowledged.
+	// Tx without a vote sequence predate the acknowledgement with
+	// commands.
+	if (pCtx->target.rosterIdx < scanRes)
+	{
+		DevRecInfo_t *pDev = &discTxList[pCtx->target.rosterIdx];
+
+		pDev->txEpoch = (dataLen > ETX_DATA_EPOCH_IDX) ?
+				pData[ETX_DATA_EPOCH_IDX] : voteEpoch;
+		if (dataLen < ETX_DATA_SEQ_IDX + 2)
+		{
+			pDev->ackPlain = TRUE;
+		}
+	}
+
+	// Whole journal records only
+	if (dataLen > ETX_DATA_JOURNAL_IDX && pData[ETX_DATA_VER_IDX] >= 2)
+	{
+		num = pData[ETX_DATA_JOURNAL_IDX];
+		if (num > (dataLen - ETX_DATA_JOURNAL_IDX - 1) / ETX_DATA_LEN)
+		{
+			num = (dataLen - ETX_DATA_JOURNAL_IDX - 1) / ETX_DATA_LEN;
+		}
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		if (!EBS_takeVote(pCtx,
+				&pData[ETX_DATA_JOURNAL_IDX + 1 + i * ETX_DATA_LEN],
+				ETX_DATA_LEN))
+		{
 			break;
-	memcpy(pVacantSlot->addr, discTxList[index].addr, B_ADDR_LEN);
-	memcpy(pVacantSlot->txDevID, discTxList[index].txDevID, ETX_DEVID_LEN);
-	pVacantSlot->addrType = discTxList[index].addrType;
-	// TODO: need a targetList manager to find next vacant
+		}
+		taken++;
+	}
+	if (taken == num && EBS_takeVote(pCtx, pData, recLen))
+	{
+		taken++;
+	}
+	pCtx->pollDrained = (taken == num + 1);
+
+	// A bare acknowledgement would free the votes left too
+	if (taken == 0 || (!pCtx->pollDrained && pCtx->target.rosterIdx < scanRes
+			&& discTxList[pCtx->target.rosterIdx].ackPlain))
+	{
+		EBS_updatePollState(pCtx, EBS_POLL_STATE_TERMINATE);
+	} else
+	{
+		EBS_updatePollState(pCtx, EBS_POLL_STATE_WRITE);
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_takeVote
+ *
+ * @brief   Take one vote record of a Tx. Only once the vote is in the
+ *          host stream may the Tx be acknowledged. A vote cast in an
+ *          earlier epoch, one the host already has, or the record of a
+ *          Tx that has not voted yet is only acknowledged.
+ *
+ * @param   pCtx - link the record came in on, pollSeq follows the
+ *          votes taken
+ * @param   pData - record, see ETX_DATA_LEN
+ * @param   dataLen - record length, older Tx send a prefix
+ *
+ * @return  FALSE if the host stream is full, the vote stays at the Tx
+ */
+static bool EBS_takeVote(EbsConnCtx_t *pCtx, const uint8_t *pData,
+		uint8_t dataLen) {
+	bool hasSeq = (dataLen >= ETX_DATA_SEQ_IDX + 2);
+	EbsVoteRec_t rec;
+
+	memcpy(rec.txDevID, pCtx->target.txDevID, ETX_DEVID_LEN);
+	rec.dataVer = pCtx->pollVer;
+	rec.vote = pData[0];
+	rec.voteSeq = hasSeq ? BUILD_UINT16(pData[ETX_DATA_SEQ_IDX],
+			pData[ETX_DATA_SEQ_IDX + 1]) : 0;
+	rec.epoch = (dataLen > ETX_DATA_EPOCH_IDX) ?
+			pData[ETX_DATA_EPOCH_IDX] : voteEpoch;
+	rec.castMs = 0;
+	rec.battMv = 0;
+	if (dataLen >= ETX_DATA_LEN && pData[ETX_DATA_VER_IDX] >= 1)
+	{
+		rec.castMs = BUILD_UINT32(pData[ETX_DATA_TIME_IDX],
+				pData[ETX_DATA_TIME_IDX + 1],
+				pData[ETX_DATA_TIME_IDX + 2],
+				pData[ETX_DATA_TIME_IDX + 3]);
+		rec.battMv = BUILD_UINT16(pData[ETX_DATA_BATT_IDX],
+				pData[ETX_DATA_BATT_IDX + 1]);
+	}
+
+	if (rec.vote == ETX_VOTE_NONE)
+	{
+		ulog0(DEBUG, "No vote yet");
+	} else if (rec.epoch != voteEpoch)
+	{
+		staleVotes++;
+		ulog2(DEBUG, "Stale vote epoch %d/%d", rec.epoch, voteEpoch);
+	} else if (hasSeq && EBS_Vote_isDup(rec.txDevID, rec.voteSeq))
+	{
+		ulog1(DEBUG, "Dup vote %d", rec.voteSeq);
+	} else if (EBS_Uplink_push(&rec))
+	{
+		if (hasSeq)
+		{
+			EBS_Vote_accept(rec.txDevID, rec.voteSeq);
+		}
+		EBS_Tally_vote(pCtx->target.rosterIdx, rec.vote);
+	} else
+	{
+		return FALSE;
+	}
+
+	pCtx->pollSeq = rec.voteSeq;
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_packTxCmds
+ *
+ * @brief   Pack the commands for a polled Tx, the epoch first since the
+ *          votes depend on it, then the output power.
+ *
+ * @param   pDev - roster entry of the Tx
+ * @param   pBuf - [opcode, arg] * n, ETX_ACK_MAX_CMDS entries at most
+ *
+ * @return  packed length, 0 if the Tx has nothing to take
+ */
+static uint8_t EBS_packTxCmds(DevRecInfo_t *pDev, uint8_t *pBuf) {
+	uint8_t len = 0;
 
+	if (pDev->txEpoch != voteEpoch)
+	{
+		pBuf[len++] = ETX_CMD_OP_EPOCH;
+		pBuf[len++] = voteEpoch;
+	}
+
+	// Retune the Tx output power while the link is up
+	if (EBS_RssiStat_recommendTxPower(&pDev->rssiStat, pDev->txPower,
+			&pDev->cmdPower))
+	{
+		pBuf[len++] = ETX_CMD_OP_TXPWR;
+		pBuf[len++] = (uint8_t) pDev->cmdPower;
+	}
+
+	return len;
+}
+
+/*********************************************************************
+ * @fn      EBS_txCmdDone
+ *
+ * @brief   Bring the roster entry in line with a command the Tx took.
+ *
+ * @param   pDev - roster entry of the Tx
+ * @param   pCmd - [opcode, arg]
+ *
+ * @return  none
+ */
+static void EBS_txCmdDone(DevRecInfo_t *pDev, const uint8_t *pCmd) {
+	if (pCmd[0] == ETX_CMD_OP_TXPWR)
+	{
+		// Samples from now on are taken at the new power
+		pDev->txPower = (int8_t) pCmd[1];
+		EBS_RssiStat_reset(&pDev->rssiStat);
+		uout1("Tx power %d dBm", pDev->txPower);
+	} else if (pCmd[0] == ETX_CMD_OP_EPOCH)
+	{
+		pDev->txEpoch = pCmd[1];
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_setEpoch
+ *
+ * @brief   Start a new question. The tally starts over and the epoch is
+ *          broadcast to every Tx, votes cast before are stale. They
+ *          are dropped before the duplicate check, so the last
+ *          sequences seen are forgotten with a new epoch. A Tx
+ *          may miss the burst, or be built without the observer, so
+ *          every Tx not seen on the new epoch is polled once the burst
+ *          is over, or right away without broadcast.
+ *
+ * @param   epoch - question epoch
+ *
+ * @return  none
+ */
+static void EBS_setEpoch(uint8_t epoch) {
+	if (epoch != voteEpoch)
+	{
+		EBS_Vote_reset();
+	}
+	voteEpoch = epoch;
+	osal_snv_write(EBS_EPOCH_NV_ID, sizeof(voteEpoch), (uint8 *) &voteEpoch);
+	EBS_Tally_reset(voteEpoch);
+	uout1("Epoch %d", voteEpoch);
+
+	if (!EBS_Bcast_send(voteEpoch, ETX_CMD_OP_EPOCH, voteEpoch))
+	{
+		EBS_queueEpochPolls();
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_scheduleNextPoll
+ *
+ * @brief   Connect to the next queued Tx whose data is still unacknowledged.
+ *          Does nothing while a link is being established or while
+ *          every connection is in use.
+ *
+ * @return  none
+ */
+static void EBS_scheduleNextPoll(void) {
+	if (ebsState != EBS_STATE_POLLING || EBS_Conn_pending() != NULL
+			|| EBS_Conn_numActive() >= MAX_NUM_BLE_CONNS
+			|| pollQueueCount == 0)
+	{
+		return;
+	}
+
+	// The controller cannot initiate while scanning, stop the scan and
+	// come back from its GAP_DEVICE_DISCOVERY_EVENT
+	if (scanningStarted)
+	{
+		GAPCentralRole_CancelDiscovery();
+		return;
+	}
+
+	while (pollQueueCount > 0)
+	{
+		uint8_t index = pollQueue[pollQueueHead];
+		DevRecInfo_t *pDev = &discTxList[index];
+
+		pollQueueHead = (pollQueueHead + 1) % MAX_SCAN_RES;
+		pollQueueCount--;
+		pDev->queued = FALSE;
+
+		// Acknowledged since it was queued, or being polled right now
+		if (!EBS_pollDue(pDev) || pDev->linked)
+		{
+			continue;
+		}
+
+		EBS_connectTarget(index);
+		return;
+	}
 }
 
 
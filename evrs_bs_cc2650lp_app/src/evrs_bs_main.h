@@ -42,6 +42,13 @@ extern "C"
 // Max number of connections
 #define MAX_NUM_BLE_CONNS		1
 
+// Maximum number of transmitters in the scan result list, also the cap
+// on the central role's own device list. At most 255, the roster index
+// is a uint8_t.
+#ifndef MAX_SCAN_RES
+#define MAX_SCAN_RES		32
+#endif
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -51,6 +58,7 @@ extern "C"
 extern void EBS_createTask(void);
 extern uint8_t EBS_enqueueMsg(uint8_t event, uint8_t status,
 		uint8_t *pData);
+extern bool EBS_isCongested(void);
 
 /*********************************************************************
 *********************************************************************/
@@ -15,11 +15,29 @@ author	Ziyi
 #include "evrs_bs_rssi.h"
 #include "linkdb.h"
 
+// Shared read tick over every link with RSSI reads active
+static boardTimer_t rssiTmr;
 
+// Current tick period in ms, 0 while no link reads RSSI
+static uint16_t rssiTick = 0;
 
-static readRssi_t *EBS_RssiAlloc(uint16_t connHandle);
-static void EBS_RssiFree(uint16_t connHandle);
-void EBS_readRssiHandler(UArg a0);
+// Ticks skipped because the app task was backed up
+static uint32_t rssiSkipped = 0;
+
+static void EBS_RssiRetune(void);
+static void EBS_readRssiHandler(UArg a0);
+
+/*********************************************************************
+ * @fn      EBS_RssiInit
+ *
+ * @brief   Construct the shared RSSI read tick.
+ *
+ * @return  none
+ */
+void EBS_RssiInit(void) {
+	Board_Timer_construct(&rssiTmr, EBS_readRssiHandler, 0, 0, 0);
+	rssiTick = 0;
+}
 
 /*********************************************************************
  * @fn      EBS_StartRssi
@@ -35,7 +53,7 @@ void EBS_readRssiHandler(UArg a0);
  */
 bStatus_t EBS_StartRssi(uint16_t connHandle,
 		uint16_t period) {
-	readRssi_t *pRssi;
+	EbsConnCtx_t *pCtx;
 
 	// Verify link is up
 	if (!linkDB_Up(connHandle))
@@ -43,26 +61,17 @@ bStatus_t EBS_StartRssi(uint16_t connHandle,
 		return bleIncorrectMode;
 	}
 
-	// If already allocated
-	if ((pRssi = EBS_RssiFind(connHandle)) != NULL)
-	{
-		// Stop timer
-		Util_stopClock(pRssi->pClock);
-		pRssi->period = period;
-	}
-
-	// Allocate structure
-	else if ((pRssi = EBS_RssiAlloc(connHandle)) != NULL)
-	{
-		pRssi->period = period;
-	}
-	// Allocate failed
-	else
+	// Every open link owns its RSSI structure
+	if ((pCtx = EBS_Conn_find(connHandle)) == NULL)
 	{
 		return bleNoResources;
 	}
-	// Start timer
-	Util_restartClock(pRssi->pClock, period);
+
+	pCtx->rssi.connHandle = connHandle;
+	pCtx->rssi.period = period;
+	pCtx->rssi.elapsed = 0;
+
+	EBS_RssiRetune();
 	return SUCCESS;
 }
 
@@ -80,11 +89,9 @@ bStatus_t EBS_CancelRssi(uint16_t connHandle) {
 	readRssi_t *pRssi;
 	if ((pRssi = EBS_RssiFind(connHandle)) != NULL)
 	{
-		// Stop timer
-		Util_stopClock(pRssi->pClock);
+		pRssi->connHandle = GAP_CONNHANDLE_ALL;
 
-		// Free RSSI structure
-		EBS_RssiFree(connHandle);
+		EBS_RssiRetune();
 		return SUCCESS;
 	}
 	// Not found
@@ -92,102 +99,108 @@ bStatus_t EBS_CancelRssi(uint16_t connHandle) {
 }
 
 /*********************************************************************
- * @fn      gapCentralRole_RssiAlloc
+ * @fn      EBS_RssiFind
  *
- * @brief   Allocate an RSSI structure.
+ * @brief   Find an RSSI structure.
  *
  * @param   connHandle - Connection handle
  *
- * @return  pointer to structure or NULL if allocation failed.
+ * @return  pointer to structure or NULL if not found.
  */
-static readRssi_t *EBS_RssiAlloc(uint16_t connHandle) {
-	uint8_t i;
+readRssi_t *EBS_RssiFind(uint16_t connHandle) {
+	EbsConnCtx_t *pCtx = EBS_Conn_find(connHandle);
 
-	// Find free RSSI structure
-	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+	if (pCtx != NULL && pCtx->rssi.connHandle == connHandle)
 	{
-		if (readRssi[i].connHandle == GAP_CONNHANDLE_ALL)
-		{
-			readRssi_t *pRssi = &readRssi[i];
-			pRssi->pClock = (Clock_Struct *) ICall_malloc(sizeof(Clock_Struct));
-			if (pRssi->pClock)
-			{
-				Util_constructClock(pRssi->pClock,
-						EBS_readRssiHandler, 0, 0, false, i);
-				pRssi->connHandle = connHandle;
-				return pRssi;
-			}
-		}
+		return &pCtx->rssi;
 	}
-	// No free structure found
+	// Not found
 	return NULL;
 }
 
 /*********************************************************************
- * @fn      gapCentralRole_RssiFind
+ * @fn      EBS_RssiSkipped
  *
- * @brief   Find an RSSI structure.
+ * @brief   Number of RSSI ticks skipped under congestion.
  *
- * @param   connHandle - Connection handle
- *
- * @return  pointer to structure or NULL if not found.
+ * @return  skipped ticks
  */
-readRssi_t *EBS_RssiFind(uint16_t connHandle) {
-	uint8_t i;
-	// Find free RSSI structure
-	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
-	{
-		if (readRssi[i].connHandle == connHandle)
-		{
-			return &readRssi[i];
-		}
-	}
-	// Not found
-	return NULL;
+uint32_t EBS_RssiSkipped(void) {
+	return rssiSkipped;
 }
 
 /*********************************************************************
- * @fn      gapCentralRole_RssiFree
+ * @fn      EBS_RssiRetune
  *
- * @brief   Free an RSSI structure.
- *
- * @param   connHandle - Connection handle
+ * @brief   Run the shared tick at the shortest active period, stop it
+ *          when no link reads RSSI.
  *
  * @return  none
  */
-static void EBS_RssiFree(uint16_t connHandle) {
+static void EBS_RssiRetune(void) {
+	uint16_t tick = 0;
 	uint8_t i;
 
-	// Find RSSI structure
 	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
 	{
-		if (readRssi[i].connHandle == connHandle)
+		readRssi_t *pRssi = &connCtx[i].rssi;
+
+		if (pRssi->connHandle != GAP_CONNHANDLE_ALL
+				&& (tick == 0 || pRssi->period < tick))
 		{
-			readRssi_t *pRssi = &readRssi[i];
-			if (pRssi->pClock)
-			{
-				Clock_destruct(pRssi->pClock);
-
-				// Free clock struct
-				ICall_free(pRssi->pClock);
-				pRssi->pClock = NULL;
-			}
-			pRssi->connHandle = GAP_CONNHANDLE_ALL;
-			break;
+			tick = pRssi->period;
 		}
 	}
+
+	if (tick == 0)
+	{
+		Board_Timer_stop(&rssiTmr);
+	} else if (tick != rssiTick || !Board_Timer_isActive(&rssiTmr))
+	{
+		Board_Timer_stop(&rssiTmr);
+		Board_Timer_construct(&rssiTmr, EBS_readRssiHandler, tick, tick, 0);
+		Board_Timer_start(&rssiTmr);
+	}
+
+	rssiTick = tick;
 }
 
 /*********************************************************************
  * @fn      EBS_readRssiHandler
  *
- * @brief   Read RSSI handler function
+ * @brief   Shared RSSI tick handler, issues the reads of every link
+ *          whose period has elapsed. Runs in the app task.
  *
- * @param   a0 - read RSSI index
+ * @param   a0 - ignored
  *
  * @return  none
  */
-void EBS_readRssiHandler(UArg a0) {
-	EBS_enqueueMsg(EBS_RSSI_READ_EVT, SUCCESS,
-			(uint8_t *) &readRssi[a0]);
+static void EBS_readRssiHandler(UArg a0) {
+	uint8_t i;
+
+	// Each read costs a command and an event on the heap, shed it first
+	if (EBS_isCongested())
+	{
+		rssiSkipped++;
+		return;
+	}
+
+	for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+	{
+		readRssi_t *pRssi = &connCtx[i].rssi;
+
+		// If link is up and RSSI reads active
+		if (pRssi->connHandle == GAP_CONNHANDLE_ALL
+				|| !linkDB_Up(pRssi->connHandle))
+		{
+			continue;
+		}
+
+		pRssi->elapsed += rssiTick;
+		if (pRssi->elapsed >= pRssi->period)
+		{
+			pRssi->elapsed = 0;
+			VOID HCI_ReadRssiCmd(pRssi->connHandle);
+		}
+	}
 }
@@ -23,16 +23,16 @@ author	Ziyi
 #include "ble_user_config.h"
 
 #include "evrs_bs_main.h"
+#include "evrs_bs_conn.h"
 
 
 
-extern readRssi_t readRssi[MAX_NUM_BLE_CONNS];
-
-
+extern void EBS_RssiInit(void);
 extern bStatus_t EBS_StartRssi(uint16_t connHandle,
 		uint16_t period);
 extern bStatus_t EBS_CancelRssi(uint16_t connHandle);
 extern readRssi_t *EBS_RssiFind(uint16_t connHandle);
+extern uint32_t EBS_RssiSkipped(void);
 
 
 
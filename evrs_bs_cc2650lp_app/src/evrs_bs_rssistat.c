@@ -0,0 +1,190 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_rssistat.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		running RSSI statistics per link and per Tx
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "evrs_bs_rssistat.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Output power levels of the CC2650 in dBm, ascending
+static const int8_t txPowerLevels[] = {
+	-21, -18, -15, -12, -9, -6, -3, 0, 1, 2, 3, 4, 5
+};
+
+#define EBS_TXPWR_NUM_LEVELS	(sizeof(txPowerLevels) / sizeof(txPowerLevels[0]))
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_RssiStat_reset
+ *
+ * @brief   Clear the statistics.
+ *
+ * @param   pStat - statistics
+ *
+ * @return  none
+ */
+void EBS_RssiStat_reset(EbsRssiStat_t *pStat) {
+	memset(pStat, 0, sizeof(EbsRssiStat_t));
+}
+
+/*********************************************************************
+ * @fn      EBS_RssiStat_add
+ *
+ * @brief   Fold one sample into the statistics.
+ *
+ * @param   pStat - statistics
+ * @param   rssi - sample in dBm
+ *
+ * @return  none
+ */
+void EBS_RssiStat_add(EbsRssiStat_t *pStat, int8_t rssi) {
+	int16_t sample = (int16_t) rssi << EBS_RSSISTAT_EWMA_FRAC;
+	int16_t bucket;
+	uint8_t i;
+
+	if (pStat->count == 0)
+	{
+		// First sample seeds the mean and the range
+		pStat->ewma = sample;
+		pStat->min = rssi;
+		pStat->max = rssi;
+	} else
+	{
+		pStat->ewma += (sample - pStat->ewma) >> EBS_RSSISTAT_EWMA_SHIFT;
+		if (rssi < pStat->min)
+		{
+			pStat->min = rssi;
+		}
+		if (rssi > pStat->max)
+		{
+			pStat->max = rssi;
+		}
+	}
+
+	if (pStat->count < 0xFFFF)
+	{
+		pStat->count++;
+	}
+
+	bucket = (rssi - EBS_RSSISTAT_BUCKET_FLOOR) / EBS_RSSISTAT_BUCKET_DB;
+	if (bucket < 0)
+	{
+		bucket = 0;
+	} else if (bucket >= EBS_RSSISTAT_NUM_BUCKETS)
+	{
+		bucket = EBS_RSSISTAT_NUM_BUCKETS - 1;
+	}
+
+	// Halve every bucket when one saturates, the shape is what matters
+	if (pStat->hist[bucket] == 0xFF)
+	{
+		for (i = 0; i < EBS_RSSISTAT_NUM_BUCKETS; i++)
+		{
+			pStat->hist[i] >>= 1;
+		}
+	}
+	pStat->hist[bucket]++;
+}
+
+/*********************************************************************
+ * @fn      EBS_RssiStat_mean
+ *
+ * @brief   Get the weighted mean rounded to the nearest dBm.
+ *
+ * @param   pStat - statistics
+ *
+ * @return  mean in dBm, 0 without samples
+ */
+int8_t EBS_RssiStat_mean(const EbsRssiStat_t *pStat) {
+	int16_t half = 1 << (EBS_RSSISTAT_EWMA_FRAC - 1);
+
+	if (pStat->count == 0)
+	{
+		return 0;
+	}
+
+	return (int8_t) ((pStat->ewma + half) >> EBS_RSSISTAT_EWMA_FRAC);
+}
+
+/*********************************************************************
+ * @fn      EBS_RssiStat_pack
+ *
+ * @brief   Serialise a summary as count (uint16 LE), mean, min, max and
+ *          the histogram buckets, EBS_RSSISTAT_PACKED_LEN bytes.
+ *
+ * @param   pStat - statistics
+ * @param   pBuf - destination
+ *
+ * @return  number of bytes written
+ */
+uint8_t EBS_RssiStat_pack(const EbsRssiStat_t *pStat, uint8_t *pBuf) {
+	pBuf[0] = LO_UINT16(pStat->count);
+	pBuf[1] = HI_UINT16(pStat->count);
+	pBuf[2] = (uint8_t) EBS_RssiStat_mean(pStat);
+	pBuf[3] = (uint8_t) pStat->min;
+	pBuf[4] = (uint8_t) pStat->max;
+	memcpy(&pBuf[5], pStat->hist, EBS_RSSISTAT_NUM_BUCKETS);
+
+	return EBS_RSSISTAT_PACKED_LEN;
+}
+
+/*********************************************************************
+ * @fn      EBS_RssiStat_recommendTxPower
+ *
+ * @brief   Recommend the lowest Tx output power that still brings the
+ *          mean RSSI up to EBS_TXPWR_TARGET_RSSI. Decreases smaller
+ *          than EBS_TXPWR_HYSTERESIS_DB are not worth a command,
+ *          increases always are.
+ *
+ * @param   pStat - statistics taken at curPower
+ * @param   curPower - Tx output power in dBm
+ * @param   pPower - recommended output power in dBm
+ *
+ * @return  TRUE if the Tx should change its output power
+ */
+bool EBS_RssiStat_recommendTxPower(const EbsRssiStat_t *pStat,
+		int8_t curPower, int8_t *pPower) {
+	int16_t want;
+	uint8_t i;
+
+	if (curPower == EBS_TXPWR_UNKNOWN || pStat->count < EBS_TXPWR_MIN_SAMPLES)
+	{
+		return FALSE;
+	}
+
+	want = curPower + (EBS_TXPWR_TARGET_RSSI - EBS_RssiStat_mean(pStat));
+
+	// Lowest level at or above the wanted power, the top level otherwise
+	for (i = 0; i < EBS_TXPWR_NUM_LEVELS - 1; i++)
+	{
+		if (txPowerLevels[i] >= want)
+		{
+			break;
+		}
+	}
+	*pPower = txPowerLevels[i];
+
+	if (*pPower > curPower)
+	{
+		return TRUE;
+	}
+
+	return (curPower - *pPower >= EBS_TXPWR_HYSTERESIS_DB);
+}
@@ -0,0 +1,70 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_rssistat.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		running RSSI statistics per link and per Tx
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_RSSISTAT_H_
+#define EVRS_BS_RSSISTAT_H_
+
+#include "bcomdef.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// EWMA weight of a new sample is 1 / 2^EBS_RSSISTAT_EWMA_SHIFT
+#define EBS_RSSISTAT_EWMA_SHIFT		3
+
+// EWMA fraction bits
+#define EBS_RSSISTAT_EWMA_FRAC		4
+
+// Histogram, EBS_RSSISTAT_NUM_BUCKETS buckets of EBS_RSSISTAT_BUCKET_DB
+// from EBS_RSSISTAT_BUCKET_FLOOR, the end buckets take everything beyond
+#define EBS_RSSISTAT_NUM_BUCKETS	8
+#define EBS_RSSISTAT_BUCKET_FLOOR	(-100)
+#define EBS_RSSISTAT_BUCKET_DB		8
+
+// Packed summary length, see EBS_RssiStat_pack
+#define EBS_RSSISTAT_PACKED_LEN		(5 + EBS_RSSISTAT_NUM_BUCKETS)
+
+// Tx power control. The recommended power brings the mean RSSI at the
+// base station to EBS_TXPWR_TARGET_RSSI, once enough samples are in.
+#define EBS_TXPWR_TARGET_RSSI		(-70)
+#define EBS_TXPWR_MIN_SAMPLES		8
+#define EBS_TXPWR_HYSTERESIS_DB		3
+#define EBS_TXPWR_UNKNOWN			0x7F
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Running statistics of one RSSI source
+typedef struct {
+	int16_t ewma;		// mean in dBm, EBS_RSSISTAT_EWMA_FRAC fraction bits
+	int8_t min;			// lowest sample in dBm
+	int8_t max;			// highest sample in dBm
+	uint16_t count;		// samples taken, saturates
+	uint8_t hist[EBS_RSSISTAT_NUM_BUCKETS];	// relative sample counts
+} EbsRssiStat_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_RssiStat_reset(EbsRssiStat_t *pStat);
+extern void EBS_RssiStat_add(EbsRssiStat_t *pStat, int8_t rssi);
+extern int8_t EBS_RssiStat_mean(const EbsRssiStat_t *pStat);
+extern uint8_t EBS_RssiStat_pack(const EbsRssiStat_t *pStat, uint8_t *pBuf);
+extern bool EBS_RssiStat_recommendTxPower(const EbsRssiStat_t *pStat,
+		int8_t curPower, int8_t *pPower);
+
+#endif /* EVRS_BS_RSSISTAT_H_ */
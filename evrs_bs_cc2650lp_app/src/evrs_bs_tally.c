@@ -0,0 +1,188 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_tally.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		running vote counts of the current question, one vote
+ * 				per Tx
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "evrs_bs_tally.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Option of the latest vote of each roster entry, valid with tallyVoted
+// set, EBS_TALLY_NUM_OPTIONS if invalid
+static uint8_t tallyVote[MAX_SCAN_RES];
+static bool tallyVoted[MAX_SCAN_RES];
+
+// Votes per option, out of range votes and Tx that voted
+static uint16_t tallyCount[EBS_TALLY_NUM_OPTIONS];
+static uint16_t tallyInvalid = 0;
+static uint16_t tallyVoters = 0;
+
+// Bumped on every change so the host can skip unchanged snapshots
+static uint16_t tallyRev = 0;
+
+// Question epoch being counted
+static uint8_t tallyEpoch = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint8_t EBS_Tally_option(uint8_t vote);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Tally_reset
+ *
+ * @brief   Forget every vote, for a new question or a new roster.
+ *
+ * @param   epoch - question epoch counted from now on
+ *
+ * @return  none
+ */
+void EBS_Tally_reset(uint8_t epoch) {
+	tallyEpoch = epoch;
+	memset(tallyVoted, 0, sizeof(tallyVoted));
+	memset(tallyCount, 0, sizeof(tallyCount));
+	tallyInvalid = 0;
+	tallyVoters = 0;
+	tallyRev++;
+}
+
+/*********************************************************************
+ * @fn      EBS_Tally_vote
+ *
+ * @brief   Count the vote of a Tx. A later vote of the same Tx replaces
+ *          its earlier one.
+ *
+ * @param   txIdx - roster index of the Tx
+ * @param   vote - vote value as sent by the Tx, see ETX_VOTE_FIRST
+ *
+ * @return  TRUE if the counts changed
+ */
+bool EBS_Tally_vote(uint8_t txIdx, uint8_t vote) {
+	uint8_t option = EBS_Tally_option(vote);
+
+	if (txIdx >= MAX_SCAN_RES)
+	{
+		return FALSE;
+	}
+
+	if (tallyVoted[txIdx])
+	{
+		if (tallyVote[txIdx] == option)
+		{
+			return FALSE;
+		}
+
+		// Re-vote, take the superseded one out
+		if (tallyVote[txIdx] < EBS_TALLY_NUM_OPTIONS)
+		{
+			tallyCount[tallyVote[txIdx]]--;
+		} else
+		{
+			tallyInvalid--;
+		}
+	} else
+	{
+		tallyVoted[txIdx] = TRUE;
+		tallyVoters++;
+	}
+
+	tallyVote[txIdx] = option;
+	if (option < EBS_TALLY_NUM_OPTIONS)
+	{
+		tallyCount[option]++;
+	} else
+	{
+		tallyInvalid++;
+	}
+	tallyRev++;
+
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Tally_revision
+ *
+ * @brief   Revision of the counts, changes whenever they do.
+ *
+ * @return  revision
+ */
+uint16_t EBS_Tally_revision(void) {
+	return tallyRev;
+}
+
+/*********************************************************************
+ * @fn      EBS_Tally_pack
+ *
+ * @brief   Pack a snapshot of the counts, little endian:
+ *          [revision u16, epoch, voters u16, invalid u16, n,
+ *          count u16 * n]
+ *          n stops after the highest option with votes.
+ *
+ * @param   pBuf - destination, EBS_TALLY_PACKED_MAX bytes
+ *
+ * @return  packed length
+ */
+uint8_t EBS_Tally_pack(uint8_t *pBuf) {
+	uint8_t len = 0;
+	uint8_t num = EBS_TALLY_NUM_OPTIONS;
+	uint8_t i;
+
+	while (num > 0 && tallyCount[num - 1] == 0)
+	{
+		num--;
+	}
+
+	pBuf[len++] = LO_UINT16(tallyRev);
+	pBuf[len++] = HI_UINT16(tallyRev);
+	pBuf[len++] = tallyEpoch;
+	pBuf[len++] = LO_UINT16(tallyVoters);
+	pBuf[len++] = HI_UINT16(tallyVoters);
+	pBuf[len++] = LO_UINT16(tallyInvalid);
+	pBuf[len++] = HI_UINT16(tallyInvalid);
+	pBuf[len++] = num;
+	for (i = 0; i < num; i++)
+	{
+		pBuf[len++] = LO_UINT16(tallyCount[i]);
+		pBuf[len++] = HI_UINT16(tallyCount[i]);
+	}
+
+	return len;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Tally_option
+ *
+ * @brief   Option a Tx vote value stands for.
+ *
+ * @param   vote - vote value as sent by the Tx
+ *
+ * @return  option index, EBS_TALLY_NUM_OPTIONS if out of range
+ */
+static uint8_t EBS_Tally_option(uint8_t vote) {
+	uint8_t option = (uint8_t) (vote - ETX_VOTE_FIRST);
+
+	return (option < EBS_TALLY_NUM_OPTIONS) ? option : EBS_TALLY_NUM_OPTIONS;
+}
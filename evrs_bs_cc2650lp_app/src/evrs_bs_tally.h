@@ -0,0 +1,45 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_tally.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		running vote counts of the current question, one vote
+ * 				per Tx
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_TALLY_H_
+#define EVRS_BS_TALLY_H_
+
+#include "bcomdef.h"
+#include "evrs_bs_main.h"
+#include "evrs_bs_typedefs.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Options counted, vote values ETX_VOTE_FIRST + 0 .. ETX_VOTE_FIRST +
+// EBS_TALLY_NUM_OPTIONS - 1. Other values are counted as invalid.
+#ifndef EBS_TALLY_NUM_OPTIONS
+#define EBS_TALLY_NUM_OPTIONS		ETX_VOTE_NUM_OPTIONS
+#endif
+
+// Longest packed snapshot, see EBS_Tally_pack
+#define EBS_TALLY_PACKED_MAX		(8 + 2 * EBS_TALLY_NUM_OPTIONS)
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Tally_reset(uint8_t epoch);
+extern bool EBS_Tally_vote(uint8_t txIdx, uint8_t vote);
+extern uint16_t EBS_Tally_revision(void);
+extern uint8_t EBS_Tally_pack(uint8_t *pBuf);
+
+#endif /* EVRS_BS_TALLY_H_ */
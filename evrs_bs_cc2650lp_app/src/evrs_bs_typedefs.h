@@ -21,20 +21,99 @@
 
 // RSSI read data structure
 typedef struct {
-	Clock_Struct *pClock; // pointer to clock struct
 	uint16_t period;      // how often to read RSSI
+	uint16_t elapsed;     // ms since the last read
 	uint16_t connHandle;  // connection handle
 } readRssi_t;
 
 // Simple BLE Central Task Events
-#define EBS_START_DISCOVERY_EVT      	0x0001
+// #define EBS_START_DISCOVERY_EVT     	0x0001
 #define EBS_PAIRING_STATE_EVT     		0x0002
 // #define EBS_PASSCODE_NEEDED_EVT     	0x0004
-#define EBS_RSSI_READ_EVT            	0x0008
+// #define EBS_RSSI_READ_EVT           	0x0008
 #define EBS_KEY_CHANGE_EVT            	0x0010
 #define EBS_STATE_CHANGE_EVT          	0x0020
-#define EBS_CONNECTING_TIMEOUT_EVT	  	0x0040
+// #define EBS_CONNECTING_TIMEOUT_EVT	0x0040
 #define EBS_STACK_MSG_EVT				0x0080
+#define EBS_HOST_CMD_EVT				0x0001	// command frame from the host
+
+// GATT Params
+// EVRS Profile Service UUID
+#define EVRSPROFILE_SERV_UUID 			0xAFF0
+#define EVRSPROFILE_SYSID_UUID         	0xAFF2
+#define EVRSPROFILE_DEVID_UUID      	0xAFF4
+#define EVRSPROFILE_CMD_UUID        	0xAFF8
+#define EVRSPROFILE_DATA_UUID         	0xAFFE
+
+// Transmitter advertising data types
+#define ETX_ADTYPE_DEST				0xAF
+#define ETX_ADTYPE_DEVID			0xAE
+#define ETX_ADTYPE_DVER				0xAD	// data version, bumped on every vote
+#define ETX_ADTYPE_BCAST			0xAC	// base station command broadcast
+#define ETX_DEVID_LEN 				4
+#define ETX_DEVID_PREFIX			0x95
+
+// Transmitter DATA characteristic, little endian:
+// [vote, vote sequence u16, epoch, version, cast time u32, battery u16]
+// Older Tx firmware sends a prefix of it, the vote alone at least.
+// Version 1 adds the Tx uptime in ms at the vote and the battery in mV,
+// later versions only append. Version 2 appends the journal of older
+// votes the Tx holds unacknowledged, [n, record * n] oldest first, read
+// with a long read.
+#define ETX_DATA_LEN				11
+#define ETX_DATA_SEQ_IDX			1
+#define ETX_DATA_EPOCH_IDX			3
+#define ETX_DATA_VER_IDX			4
+#define ETX_DATA_TIME_IDX			5
+#define ETX_DATA_BATT_IDX			9
+#define ETX_DATA_JOURNAL_IDX		ETX_DATA_LEN
+#define ETX_JOURNAL_MAX				7
+#define ETX_DATA_MAX_LEN			(ETX_DATA_LEN + 1 + ETX_JOURNAL_MAX * ETX_DATA_LEN)
+
+// Vote values, option n of a question is ETX_VOTE_FIRST + n. The Tx
+// steps to the next option on every vote and wraps after the last.
+#define ETX_VOTE_FIRST				0xA5
+#define ETX_VOTE_NUM_OPTIONS		16
+// Vote value of the record a Tx serves before its first vote, it carries
+// the sequence of the last vote before a reset. Acknowledged only.
+#define ETX_VOTE_NONE				0xA4
+
+// Transmitter commands written to the CMD characteristic as [opcode, arg]
+// or piggybacked on the DATA acknowledgement
+#define ETX_CMD_LEN					2
+#define ETX_CMD_OP_NONE				0x00	// ends the acknowledgement commands
+#define ETX_CMD_OP_TXPWR			0x01	// arg: output power in dBm, int8
+#define ETX_CMD_OP_EPOCH			0x02	// arg: question epoch to stamp votes with
+
+// DATA acknowledgement written after a read,
+// [mark, acked vote sequence u16, (opcode, arg) * n]. Older Tx firmware
+// takes the bare mark only.
+#define ETX_ACK_MARK				0xFF
+#define ETX_ACK_HDR_LEN				3
+#define ETX_ACK_MAX_CMDS			4
+#define ETX_ACK_MAX_LEN				(ETX_ACK_HDR_LEN + ETX_ACK_MAX_CMDS * ETX_CMD_LEN)
+
+// Command broadcast, ETX_ADTYPE_BCAST value [bsID, seq, epoch, op, arg].
+// Every Tx of the base station takes the epoch and applies [op, arg] as
+// if written to CMD, repeats of a burst only once.
+#define ETX_BCAST_LEN				5
+#define ETX_BCAST_AD_LEN			(ETX_BCAST_LEN + 1)
+#define ETX_BCAST_BSID_IDX			0
+#define ETX_BCAST_SEQ_IDX			1
+#define ETX_BCAST_EPOCH_IDX			2
+#define ETX_BCAST_OP_IDX			3
+#define ETX_BCAST_ARG_IDX			4
+
+// Uplink frame types, see Board_Display_Frame
+#define EBS_FRAME_LINK_RSSI			0x10	// RSSI summaries of the open links
+#define EBS_FRAME_TX_RSSI			0x11	// RSSI summaries of roster entries
+#define EBS_FRAME_QUEUE_STATS		0x12	// app queue depths and drops
+#define EBS_FRAME_TELEMETRY			0x13	// stack, heap and queue usage
+#define EBS_FRAME_CPU_LOAD			0x14	// app task load per handler
+#define EBS_FRAME_CMD_RSP			0x15	// [command, status]
+#define EBS_FRAME_ROSTER			0x16	// roster entries, see EBS_uploadRoster
+#define EBS_FRAME_VOTE				0x17	// [seq16, count, vote records], see evrs_bs_uplink
+#define EBS_FRAME_TALLY				0x18	// vote count snapshot, see EBS_Tally_pack
 
 
 #endif /* EVRS_BS_TYPEDEFS_H_ */
@@ -0,0 +1,283 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_uplink.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		reliable vote record stream to the host, with sequence
+ * 				numbers, cumulative acknowledgements and host credits
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "board_display.h"
+#include "board_timer.h"
+#include "evrs_bs_uplink.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Send tick while records are outstanding, in ms
+#define UPLINK_TICK_PERIOD			100
+
+// Ticks without acknowledgement progress before sending again
+#define UPLINK_RTO_TICKS			10
+
+// EBS_FRAME_VOTE header: first sequence number, record count
+#define UPLINK_FRAME_HDR_LEN		3
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Retransmit buffer, record seq lives at window[seq % EBS_UPLINK_WINDOW].
+// Sequence numbers in [ackSeq, sendSeq) were sent and wait for an
+// acknowledgement, [sendSeq, nextSeq) wait for credit or ring space.
+static EbsVoteRec_t window[EBS_UPLINK_WINDOW];
+static uint16_t ackSeq = 0;		// oldest record not acknowledged
+static uint16_t sendSeq = 0;	// next record to send
+static uint16_t nextSeq = 0;	// sequence number of the next record pushed
+static uint16_t sentMax = 0;	// highest sendSeq reached, tells resends apart
+
+// Records the host accepts past ackSeq, granted with each acknowledgement
+static uint8_t credit = 0;
+
+// Send tick and ticks since acknowledgement progress
+static boardTimer_t uplinkTmr;
+static uint8_t idleTicks = 0;
+
+// Stream counters
+static EbsUplinkStats_t uplinkStats;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void EBS_Uplink_pump(void);
+static void EBS_Uplink_tick(UArg a0);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Uplink_init
+ *
+ * @brief   Empty the stream. The host grants no credit until its first
+ *          acknowledgement.
+ *
+ * @return  none
+ */
+void EBS_Uplink_init(void) {
+	ackSeq = 0;
+	sendSeq = 0;
+	nextSeq = 0;
+	sentMax = 0;
+	credit = 0;
+	idleTicks = 0;
+	memset(&uplinkStats, 0, sizeof(uplinkStats));
+
+	Board_Timer_construct(&uplinkTmr, EBS_Uplink_tick, UPLINK_TICK_PERIOD,
+			UPLINK_TICK_PERIOD, 0);
+}
+
+/*********************************************************************
+ * @fn      EBS_Uplink_push
+ *
+ * @brief   Queue a vote record for the host and send it if credit
+ *          allows.
+ *
+ * @param   pRec - record
+ *
+ * @return  FALSE if the retransmit buffer is full, the caller must keep
+ *          the vote unacknowledged at the Tx and poll it again later
+ */
+bool EBS_Uplink_push(const EbsVoteRec_t *pRec) {
+	if ((uint16_t) (nextSeq - ackSeq) >= EBS_UPLINK_WINDOW)
+	{
+		uplinkStats.refused++;
+		return FALSE;
+	}
+
+	window[nextSeq & (EBS_UPLINK_WINDOW - 1)] = *pRec;
+	nextSeq++;
+	uplinkStats.pushed++;
+
+	if (!Board_Timer_isActive(&uplinkTmr))
+	{
+		idleTicks = 0;
+		Board_Timer_start(&uplinkTmr);
+	}
+
+	EBS_Uplink_pump();
+
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Uplink_ack
+ *
+ * @brief   Host acknowledgement. Frees every record before hostSeq and
+ *          lets the host hold hostCredit records past it.
+ *
+ * @param   hostSeq - next sequence number the host expects
+ * @param   hostCredit - records the host accepts from hostSeq on
+ *
+ * @return  none
+ */
+void EBS_Uplink_ack(uint16_t hostSeq, uint8_t hostCredit) {
+	uint16_t acked = hostSeq - ackSeq;
+
+	// Ignore acknowledgements of records never sent
+	if (acked > (uint16_t) (sentMax - ackSeq))
+	{
+		return;
+	}
+
+	if (acked != 0)
+	{
+		ackSeq = hostSeq;
+		uplinkStats.acked += acked;
+		idleTicks = 0;
+
+		// Records the host already has need not go out again
+		if ((int16_t) (sendSeq - ackSeq) < 0)
+		{
+			sendSeq = ackSeq;
+		}
+	}
+
+	credit = hostCredit;
+
+	if (ackSeq == nextSeq)
+	{
+		Board_Timer_stop(&uplinkTmr);
+	} else if (!Board_Timer_isActive(&uplinkTmr))
+	{
+		idleTicks = 0;
+		Board_Timer_start(&uplinkTmr);
+	}
+
+	EBS_Uplink_pump();
+}
+
+/*********************************************************************
+ * @fn      EBS_Uplink_getStats
+ *
+ * @brief   Copy the stream counters.
+ *
+ * @param   pStats - destination
+ *
+ * @return  none
+ */
+void EBS_Uplink_getStats(EbsUplinkStats_t *pStats) {
+	*pStats = uplinkStats;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Uplink_pump
+ *
+ * @brief   Send the records waiting in [sendSeq, nextSeq) while the
+ *          host credit and the UART ring have room. Never blocks, what
+ *          does not fit waits for the next tick or acknowledgement.
+ *
+ * @return  none
+ */
+static void EBS_Uplink_pump(void) {
+	// Static, the pump runs deep under the GATT handlers on a small
+	// task stack
+	static uint8_t buf[UPLINK_FRAME_HDR_LEN
+			+ EBS_UPLINK_FRAME_MAX_REC * EBS_VOTE_REC_LEN];
+
+	for (;;)
+	{
+		uint16_t limit = ackSeq + credit;
+		uint8_t count = 0;
+		uint8_t len = UPLINK_FRAME_HDR_LEN;
+		uint16_t seq = sendSeq;
+
+		while (seq != nextSeq && (int16_t) (limit - seq) > 0
+				&& count < EBS_UPLINK_FRAME_MAX_REC)
+		{
+			EbsVoteRec_t *pRec = &window[seq & (EBS_UPLINK_WINDOW - 1)];
+
+			memcpy(&buf[len], pRec->txDevID, ETX_DEVID_LEN);
+			len += ETX_DEVID_LEN;
+			buf[len++] = pRec->dataVer;
+			buf[len++] = pRec->vote;
+			buf[len++] = LO_UINT16(pRec->voteSeq);
+			buf[len++] = HI_UINT16(pRec->voteSeq);
+			buf[len++] = pRec->epoch;
+			buf[len++] = BREAK_UINT32(pRec->castMs, 0);
+			buf[len++] = BREAK_UINT32(pRec->castMs, 1);
+			buf[len++] = BREAK_UINT32(pRec->castMs, 2);
+			buf[len++] = BREAK_UINT32(pRec->castMs, 3);
+			buf[len++] = LO_UINT16(pRec->battMv);
+			buf[len++] = HI_UINT16(pRec->battMv);
+			seq++;
+			count++;
+		}
+
+		// Nothing to send, or the UART would drop the frame
+		if (count == 0 || Board_Display_TxFree() < len + 4)
+		{
+			return;
+		}
+
+		buf[0] = LO_UINT16(sendSeq);
+		buf[1] = HI_UINT16(sendSeq);
+		buf[2] = count;
+		Board_Display_Frame(EBS_FRAME_VOTE, buf, len);
+
+		// Split first sends from resends
+		while (sendSeq != seq)
+		{
+			if ((int16_t) (sendSeq - sentMax) >= 0)
+			{
+				sentMax = sendSeq + 1;
+				uplinkStats.sent++;
+			} else
+			{
+				uplinkStats.resent++;
+			}
+			sendSeq++;
+		}
+	}
+}
+
+/*********************************************************************
+ * @fn      EBS_Uplink_tick
+ *
+ * @brief   Send tick. Retries what the UART ring or credit held back,
+ *          and goes back to the oldest unacknowledged record when the
+ *          host makes no progress for UPLINK_RTO_TICKS.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void EBS_Uplink_tick(UArg a0) {
+	if (ackSeq == nextSeq)
+	{
+		Board_Timer_stop(&uplinkTmr);
+		return;
+	}
+
+	if (sendSeq != ackSeq && ++idleTicks >= UPLINK_RTO_TICKS)
+	{
+		idleTicks = 0;
+		sendSeq = ackSeq;
+	}
+
+	EBS_Uplink_pump();
+}
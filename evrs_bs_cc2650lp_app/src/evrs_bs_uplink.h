@@ -0,0 +1,71 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_uplink.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		reliable vote record stream to the host, with sequence
+ * 				numbers, cumulative acknowledgements and host credits
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_UPLINK_H_
+#define EVRS_BS_UPLINK_H_
+
+#include "bcomdef.h"
+#include "evrs_bs_typedefs.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Vote records kept until the host acknowledges them, must be a power of 2
+#ifndef EBS_UPLINK_WINDOW
+#define EBS_UPLINK_WINDOW			32
+#endif
+
+// Most records in one EBS_FRAME_VOTE frame
+#define EBS_UPLINK_FRAME_MAX_REC	8
+
+// Packed vote record length: Tx ID, data version, vote, vote sequence,
+// epoch, cast time, battery
+#define EBS_VOTE_REC_LEN			(ETX_DEVID_LEN + 11)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Vote read from a Tx
+typedef struct {
+	uint8_t txDevID[ETX_DEVID_LEN];	// Tx ID
+	uint8_t dataVer;				// data version the vote was read at
+	uint8_t vote;					// DATA characteristic value
+	uint16_t voteSeq;				// Tx vote sequence, 0 if the Tx sends none
+	uint8_t epoch;					// question epoch the vote was cast in
+	uint32_t castMs;				// Tx uptime at the vote, 0 if not sent
+	uint16_t battMv;				// Tx battery at the vote, 0 if not sent
+} EbsVoteRec_t;
+
+// Stream counters
+typedef struct {
+	uint32_t pushed;	// records accepted
+	uint32_t refused;	// records refused by a full window
+	uint32_t sent;		// records sent for the first time
+	uint32_t resent;	// records sent again after a timeout
+	uint32_t acked;		// records acknowledged by the host
+} EbsUplinkStats_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Uplink_init(void);
+extern bool EBS_Uplink_push(const EbsVoteRec_t *pRec);
+extern void EBS_Uplink_ack(uint16_t hostSeq, uint8_t hostCredit);
+extern void EBS_Uplink_getStats(EbsUplinkStats_t *pStats);
+
+#endif /* EVRS_BS_UPLINK_H_ */
@@ -0,0 +1,165 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_vote.c
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		last vote sequence seen per Tx ID, drops votes that
+ * 				were already forwarded to the host
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#include <string.h>
+
+#include "evrs_bs_vote.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Last forwarded vote of one Tx
+typedef struct {
+	uint8_t txDevID[ETX_DEVID_LEN];	// Tx ID
+	uint16_t voteSeq;				// sequence of the last forwarded vote
+	uint16_t stamp;					// voteClock at the last update
+} EbsVoteEntry_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static EbsVoteEntry_t voteTable[EBS_VOTE_TABLE_SIZE];
+static uint8_t voteUsed = 0;
+
+// Counts accepted votes, orders the entries for replacement
+static uint16_t voteClock = 0;
+
+// Votes dropped as already forwarded
+static uint32_t voteDups = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static EbsVoteEntry_t *EBS_Vote_find(const uint8_t *pTxDevID);
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Vote_reset
+ *
+ * @brief   Forget every Tx.
+ *
+ * @return  none
+ */
+void EBS_Vote_reset(void) {
+	voteUsed = 0;
+	voteClock = 0;
+}
+
+/*********************************************************************
+ * @fn      EBS_Vote_isDup
+ *
+ * @brief   Check a vote against the last one forwarded for its Tx. The
+ *          sequence compares modulo 2^16, so the Tx can wrap it.
+ *
+ * @param   pTxDevID - Tx ID
+ * @param   voteSeq - vote sequence read from the Tx
+ *
+ * @return  TRUE if the vote, or a later one, was already forwarded
+ */
+bool EBS_Vote_isDup(const uint8_t *pTxDevID, uint16_t voteSeq) {
+	EbsVoteEntry_t *pEntry = EBS_Vote_find(pTxDevID);
+
+	if (pEntry == NULL || (int16_t) (voteSeq - pEntry->voteSeq) > 0)
+	{
+		return FALSE;
+	}
+
+	voteDups++;
+	return TRUE;
+}
+
+/*********************************************************************
+ * @fn      EBS_Vote_accept
+ *
+ * @brief   Record a vote as forwarded.
+ *
+ * @param   pTxDevID - Tx ID
+ * @param   voteSeq - vote sequence
+ *
+ * @return  none
+ */
+void EBS_Vote_accept(const uint8_t *pTxDevID, uint16_t voteSeq) {
+	EbsVoteEntry_t *pEntry = EBS_Vote_find(pTxDevID);
+
+	if (pEntry == NULL)
+	{
+		if (voteUsed < EBS_VOTE_TABLE_SIZE)
+		{
+			pEntry = &voteTable[voteUsed++];
+		} else
+		{
+			uint8_t i;
+
+			// Table full, take over the entry idle the longest
+			pEntry = &voteTable[0];
+			for (i = 1; i < EBS_VOTE_TABLE_SIZE; i++)
+			{
+				if ((uint16_t) (voteClock - voteTable[i].stamp)
+						> (uint16_t) (voteClock - pEntry->stamp))
+				{
+					pEntry = &voteTable[i];
+				}
+			}
+		}
+		memcpy(pEntry->txDevID, pTxDevID, ETX_DEVID_LEN);
+	}
+
+	pEntry->voteSeq = voteSeq;
+	pEntry->stamp = voteClock++;
+}
+
+/*********************************************************************
+ * @fn      EBS_Vote_dups
+ *
+ * @brief   Number of votes dropped as already forwarded.
+ *
+ * @return  count
+ */
+uint32_t EBS_Vote_dups(void) {
+	return voteDups;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      EBS_Vote_find
+ *
+ * @brief   Get the entry of a Tx.
+ *
+ * @param   pTxDevID - Tx ID
+ *
+ * @return  entry, NULL if the Tx is not tracked
+ */
+static EbsVoteEntry_t *EBS_Vote_find(const uint8_t *pTxDevID) {
+	uint8_t i;
+
+	for (i = 0; i < voteUsed; i++)
+	{
+		if (memcmp(voteTable[i].txDevID, pTxDevID, ETX_DEVID_LEN) == 0)
+		{
+			return &voteTable[i];
+		}
+	}
+
+	return NULL;
+}
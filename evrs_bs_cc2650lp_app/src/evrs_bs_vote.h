@@ -0,0 +1,41 @@
+/****************************************
+ *
+ * @filename 	evrs_bs_vote.h
+ *
+ * @project 	evrs_bs_cc2650lp_app
+ *
+ * @brief 		last vote sequence seen per Tx ID, drops votes that
+ * 				were already forwarded to the host
+ *
+ * @date 		19 Oct. 2026
+ *
+ * @author		Ziyi@outlook.com.au
+ *
+ ****************************************/
+
+#ifndef EVRS_BS_VOTE_H_
+#define EVRS_BS_VOTE_H_
+
+#include "bcomdef.h"
+#include "evrs_bs_typedefs.h"
+#include "evrs_bs_main.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Tx IDs tracked, the least recently voting one is forgotten first
+#ifndef EBS_VOTE_TABLE_SIZE
+#define EBS_VOTE_TABLE_SIZE			MAX_SCAN_RES
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+extern void EBS_Vote_reset(void);
+extern bool EBS_Vote_isDup(const uint8_t *pTxDevID, uint16_t voteSeq);
+extern void EBS_Vote_accept(const uint8_t *pTxDevID, uint16_t voteSeq);
+extern uint32_t EBS_Vote_dups(void);
+
+#endif /* EVRS_BS_VOTE_H_ */
@@ -16,26 +16,148 @@
 #define BOARDDISPLAY_H
 
 #include <stdint.h>
+#include "board_log.h"
+
+// UART settings, text lines and binary frames share the port
+#define BOARD_DISPLAY_BAUD_RATE		115200
+
+// Longest text line, including the line end
+#define BOARD_DISPLAY_LINE_LEN		80
+
+// Binary frame: SOF, type, len, payload[len], checksum
+// checksum is the XOR of type, len and every payload byte
+#define BOARD_DISPLAY_FRAME_SOF		0xA5
+#define BOARD_DISPLAY_FRAME_MAX		250
+
+// Transmit ring size in bytes, must be a power of 2. Output is copied
+// to the ring and sent in the background, a line or frame that does not
+// fit is dropped whole.
+#ifndef BOARD_DISPLAY_TX_RING
+#define BOARD_DISPLAY_TX_RING		512
+#endif
+
+// Longest received frame payload, longer frames are dropped
+#ifndef BOARD_DISPLAY_RX_MAX
+#define BOARD_DISPLAY_RX_MAX		128
+#endif
+
+// Received frame handler, runs in the UART callback context. The payload
+// is only valid until it returns.
+typedef void (*boardDisplayRxCB_t)(uint8_t type, const uint8_t *pData, uint8_t len);
 
 void Board_Display_Init();
 void Board_Display_Print(uintptr_t fmt,	uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3, uintptr_t a4);
+void Board_Display_Frame(uint8_t type, const uint8_t *pData, uint8_t len);
+void Board_Display_RxStart(boardDisplayRxCB_t pfnFrame);
+uint16_t Board_Display_TxFree(void);
+uint32_t Board_Display_TxDrops(void);
+
+// Log levels, lower is more severe
+#define BOARD_DISPLAY_LVL_ERR		1
+#define BOARD_DISPLAY_LVL_WARN		2
+#define BOARD_DISPLAY_LVL_INFO		3
+#define BOARD_DISPLAY_LVL_DEBUG		4
 
-#  define uout0(fmt) \
+// Build level, sites above it compile to nothing and their arguments
+// are not evaluated. Sites at or below it are still filtered at run time
+// by Board_Display_SetLevel.
+#ifndef BOARD_DISPLAY_LEVEL
+#define BOARD_DISPLAY_LEVEL			BOARD_DISPLAY_LVL_INFO
+#endif
+
+// Run time level, read by every log site
+extern uint8_t boardDisplayLevel;
+
+void Board_Display_SetLevel(uint8_t level);
+
+// Log sites. By default a site sends its ID and raw arguments through
+// board_log and the format string is left out of the image, arguments
+// must then be integers. Build with BOARD_DISPLAY_TEXT to format the
+// lines on the target instead.
+#ifdef BOARD_DISPLAY_TEXT
+
+#  define uoutRaw0(fmt) \
     Board_Display_Print((uintptr_t)(fmt), 0, 0, 0, 0, 0)
 
-#  define uout1(fmt, a0) \
+#  define uoutRaw1(fmt, a0) \
     Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), 0, 0, 0, 0)
 
-#  define uout2(fmt, a0, a1) \
+#  define uoutRaw2(fmt, a0, a1) \
     Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), (uintptr_t)(a1), 0, 0, 0)
 
-#  define uout3(fmt, a0, a1, a2) \
+#  define uoutRaw3(fmt, a0, a1, a2) \
     Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), 0, 0)
 
-#  define uout4(fmt, a0, a1, a2, a3) \
+#  define uoutRaw4(fmt, a0, a1, a2, a3) \
     Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), 0)
 
-#  define uout4(fmt, a0, a1, a2, a3, a4) \
-    Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4)
+#  define uoutRaw5(fmt, a0, a1, a2, a3, a4) \
+    Board_Display_Print((uintptr_t)(fmt), (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4))
+
+#else
+
+#  define uoutRaw0(fmt) \
+    Board_Log_write(BOARD_LOG_ID, 0, 0, 0, 0, 0, 0)
+
+#  define uoutRaw1(fmt, a0) \
+    Board_Log_write(BOARD_LOG_ID, 1, (uintptr_t)(a0), 0, 0, 0, 0)
+
+#  define uoutRaw2(fmt, a0, a1) \
+    Board_Log_write(BOARD_LOG_ID, 2, (uintptr_t)(a0), (uintptr_t)(a1), 0, 0, 0)
+
+#  define uoutRaw3(fmt, a0, a1, a2) \
+    Board_Log_write(BOARD_LOG_ID, 3, (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), 0, 0)
+
+#  define uoutRaw4(fmt, a0, a1, a2, a3) \
+    Board_Log_write(BOARD_LOG_ID, 4, (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), 0)
+
+#  define uoutRaw5(fmt, a0, a1, a2, a3, a4) \
+    Board_Log_write(BOARD_LOG_ID, 5, (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4))
+
+#endif
+
+// Level gates, ERR, WARN, INFO or DEBUG after the UOUT_ prefix
+#define UOUT_AT(lvl, out) \
+    do { if (boardDisplayLevel >= (lvl)) { out; } } while (0)
+
+#if BOARD_DISPLAY_LEVEL >= BOARD_DISPLAY_LVL_ERR
+#  define UOUT_ERR(out)		UOUT_AT(BOARD_DISPLAY_LVL_ERR, out)
+#else
+#  define UOUT_ERR(out)		do { } while (0)
+#endif
+
+#if BOARD_DISPLAY_LEVEL >= BOARD_DISPLAY_LVL_WARN
+#  define UOUT_WARN(out)	UOUT_AT(BOARD_DISPLAY_LVL_WARN, out)
+#else
+#  define UOUT_WARN(out)	do { } while (0)
+#endif
+
+#if BOARD_DISPLAY_LEVEL >= BOARD_DISPLAY_LVL_INFO
+#  define UOUT_INFO(out)	UOUT_AT(BOARD_DISPLAY_LVL_INFO, out)
+#else
+#  define UOUT_INFO(out)	do { } while (0)
+#endif
+
+#if BOARD_DISPLAY_LEVEL >= BOARD_DISPLAY_LVL_DEBUG
+#  define UOUT_DEBUG(out)	UOUT_AT(BOARD_DISPLAY_LVL_DEBUG, out)
+#else
+#  define UOUT_DEBUG(out)	do { } while (0)
+#endif
+
+// Leveled log sites, e.g. ulog1(DEBUG, "Read rsp: 0x%02x", val)
+#define ulog0(lvl, fmt)							UOUT_##lvl(uoutRaw0(fmt))
+#define ulog1(lvl, fmt, a0)						UOUT_##lvl(uoutRaw1(fmt, a0))
+#define ulog2(lvl, fmt, a0, a1)					UOUT_##lvl(uoutRaw2(fmt, a0, a1))
+#define ulog3(lvl, fmt, a0, a1, a2)				UOUT_##lvl(uoutRaw3(fmt, a0, a1, a2))
+#define ulog4(lvl, fmt, a0, a1, a2, a3)			UOUT_##lvl(uoutRaw4(fmt, a0, a1, a2, a3))
+#define ulog5(lvl, fmt, a0, a1, a2, a3, a4)		UOUT_##lvl(uoutRaw5(fmt, a0, a1, a2, a3, a4))
+
+// Plain log sites are INFO
+#define uout0(fmt)								ulog0(INFO, fmt)
+#define uout1(fmt, a0)							ulog1(INFO, fmt, a0)
+#define uout2(fmt, a0, a1)						ulog2(INFO, fmt, a0, a1)
+#define uout3(fmt, a0, a1, a2)					ulog3(INFO, fmt, a0, a1, a2)
+#define uout4(fmt, a0, a1, a2, a3)				ulog4(INFO, fmt, a0, a1, a2, a3)
+#define uout5(fmt, a0, a1, a2, a3, a4)			ulog5(INFO, fmt, a0, a1, a2, a3, a4)
 
 #endif
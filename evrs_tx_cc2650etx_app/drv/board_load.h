@@ -0,0 +1,113 @@
+/*****************************************************************************
+
+file	board_load.h
+
+brief	This file contains the CPU load metering definitions and
+		prototypes. Time spent in the owner task is charged to the
+		handler slot it is running, nested slots are charged exclusively.
+
+proj	EVRS
+
+date	1019pm 19 Oct 2026
+
+author	Ziyi
+
+*****************************************************************************/
+
+#ifndef BOARD_LOAD_H
+#define BOARD_LOAD_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*****************************************************************************
+ * Constants
+ */
+
+/** Number of handler slots **/
+#ifndef BOARD_LOAD_MAX_SLOTS
+#define BOARD_LOAD_MAX_SLOTS		6
+#endif
+
+/** Slot charged by the UART display, app slots start at BOARD_LOAD_SLOT_APP **/
+#define BOARD_LOAD_SLOT_DISPLAY		0
+#define BOARD_LOAD_SLOT_APP			1
+
+/** No slot running **/
+#define BOARD_LOAD_SLOT_NONE		0xFF
+
+/*****************************************************************************
+ * Typedefs
+ */
+
+/** Slot counters, times in RTOS clock ticks **/
+typedef struct
+{
+    uint32_t busy;		// time charged to the slot
+    uint32_t maxCall;	// longest single call, nested slots included
+    uint16_t calls;		// calls entered, saturates
+} boardLoadSlot_t;
+
+/** Handler entry mark, kept on the caller stack until the exit **/
+typedef struct
+{
+    uint8_t slot;		// slot entered, BOARD_LOAD_SLOT_NONE if not metered
+    uint8_t prev;		// slot running before the entry
+    uint32_t start;		// entry time
+} boardLoadMark_t;
+
+/*****************************************************************************
+ * @fn      Board_Load_init
+ *
+ * @brief   Start metering the calling task, other tasks are ignored.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Load_init(void);
+
+/*****************************************************************************
+ * @fn      Board_Load_enter
+ *
+ * @brief   Charge time to a slot until the matching Board_Load_exit.
+ *
+ * @param   slot - slot
+ 			pMark - entry mark
+ *
+ * @return  none
+ */
+void Board_Load_enter(uint8_t slot, boardLoadMark_t *pMark);
+
+/*****************************************************************************
+ * @fn      Board_Load_exit
+ *
+ * @brief   Go back to the slot running before the matching entry.
+ *
+ * @param   pMark - entry mark
+ *
+ * @return  none
+ */
+void Board_Load_exit(const boardLoadMark_t *pMark);
+
+/*****************************************************************************
+ * @fn      Board_Load_collect
+ *
+ * @brief   Copy and clear the slot counters.
+ *
+ * @param   pSlots - destination, BOARD_LOAD_MAX_SLOTS entries
+ *
+ * @return  length of the window the counters cover in RTOS clock ticks
+ */
+uint32_t Board_Load_collect(boardLoadSlot_t *pSlots);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_LOAD_H */
@@ -0,0 +1,201 @@
+/*****************************************************************************
+
+ file	board_log.c
+
+ brief	This file contains the tokenized log. Records are packed into a
+ RAM buffer and sent as one display frame:
+
+ [base ms u32] then per record [id u16][dt varint][arg varint]...
+
+ dt is the time since the previous record in ms, 0 for the first one.
+ Arguments are zigzag varint coded, the host knows how many a site has
+ from its format string.
+
+ proj	EVRS
+
+ date	1019pm 19 Oct 2026
+
+ author	Ziyi
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * Includes
+ */
+
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "board_log.h"
+#include "board_display.h"
+
+/*********************************************************************
+ * Constants
+ */
+
+// Frame header, the base time
+#define BOARD_LOG_HDR_LEN			4
+
+// Longest record: id, dt and every argument at 5 bytes
+#define BOARD_LOG_REC_MAX			(2 + 5 + 5 * BOARD_LOG_MAX_ARGS)
+
+/*********************************************************************
+ * Local Variables
+ */
+
+// Record buffers, one filling while the other is sent
+static uint8_t logBuf[2][BOARD_LOG_BUF_LEN];
+static uint8_t logCur = 0;
+static uint16_t logLen = 0;
+
+// Clock ticks per ms and the time of the last record in ticks
+static uint32_t logTicksPerMs = 0;
+static uint32_t logLast;
+
+/*********************************************************************
+ * Local Functions
+ */
+
+static uint8_t Board_Log_varint(uint8_t *pBuf, uint32_t value);
+
+/*********************************************************************
+ * Public Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Log_write
+ *
+ * @brief   Append a record to the buffer.
+ *
+ * @param   id - log site ID
+ nArgs - number of arguments used
+ a0 .. a4 - arguments
+ *
+ * @return  none
+ */
+void Board_Log_write(uint16_t id, uint8_t nArgs, uintptr_t a0, uintptr_t a1,
+		uintptr_t a2, uintptr_t a3, uintptr_t a4) {
+	uintptr_t args[BOARD_LOG_MAX_ARGS];
+	uint8_t argBuf[5 * BOARD_LOG_MAX_ARGS];
+	uint8_t argLen = 0;
+	uint8_t *pRec;
+	uint32_t now;
+	uint32_t dt;
+	uint32_t key;
+	uint8_t i;
+
+	if (logTicksPerMs == 0)
+	{
+		logTicksPerMs = (Clock_tickPeriod < 1000) ?
+				1000 / Clock_tickPeriod : 1;
+	}
+
+	// Code the arguments outside the critical section
+	args[0] = a0;
+	args[1] = a1;
+	args[2] = a2;
+	args[3] = a3;
+	args[4] = a4;
+	for (i = 0; i < nArgs && i < BOARD_LOG_MAX_ARGS; i++)
+	{
+		int32_t v = (int32_t) args[i];
+
+		argLen += Board_Log_varint(&argBuf[argLen],
+				((uint32_t) v << 1) ^ (uint32_t) (v >> 31));
+	}
+
+	for (;;)
+	{
+		key = Hwi_disable();
+		if (logLen + BOARD_LOG_REC_MAX <= BOARD_LOG_BUF_LEN)
+		{
+			break;
+		}
+		Hwi_restore(key);
+
+		// Make room, an empty buffer always takes a record
+		Board_Log_flush();
+	}
+
+	now = Clock_getTicks();
+	pRec = &logBuf[logCur][0];
+
+	if (logLen == 0)
+	{
+		uint32_t base = now / logTicksPerMs;
+
+		pRec[0] = base & 0xFF;
+		pRec[1] = (base >> 8) & 0xFF;
+		pRec[2] = (base >> 16) & 0xFF;
+		pRec[3] = (base >> 24) & 0xFF;
+		logLen = BOARD_LOG_HDR_LEN;
+		logLast = now;
+	}
+
+	// Step the last record time by whole ms so the rest is not lost
+	dt = (now - logLast) / logTicksPerMs;
+	logLast += dt * logTicksPerMs;
+
+	pRec += logLen;
+	pRec[0] = id & 0xFF;
+	pRec[1] = id >> 8;
+	logLen += 2;
+	logLen += Board_Log_varint(&pRec[2], dt);
+	for (i = 0; i < argLen; i++)
+	{
+		logBuf[logCur][logLen++] = argBuf[i];
+	}
+	Hwi_restore(key);
+}
+
+/*****************************************************************************
+ * @fn      Board_Log_flush
+ *
+ * @brief   Send the buffered records.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Log_flush(void) {
+	uint8_t *pBuf;
+	uint16_t len;
+	uint32_t key;
+
+	key = Hwi_disable();
+	len = logLen;
+	pBuf = logBuf[logCur];
+	logCur ^= 1;
+	logLen = 0;
+	Hwi_restore(key);
+
+	if (len > 0)
+	{
+		Board_Display_Frame(BOARD_LOG_FRAME, pBuf, len);
+	}
+}
+
+/*********************************************************************
+ * Local Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Log_varint
+ *
+ * @brief   Code a value 7 bits a byte, low bits first.
+ *
+ * @param   pBuf - destination, 5 bytes at most are written
+ value - value
+ *
+ * @return  number of bytes written
+ */
+static uint8_t Board_Log_varint(uint8_t *pBuf, uint32_t value) {
+	uint8_t len = 0;
+
+	while (value >= 0x80)
+	{
+		pBuf[len++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	pBuf[len++] = value;
+
+	return len;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+
+file	board_log.h
+
+brief	This file contains the tokenized log definitions and prototypes.
+		A log site sends its ID, a timestamp and its raw arguments, the
+		format string stays on the host, see tools/evrs_logdecode.py.
+
+proj	EVRS
+
+date	1019pm 19 Oct 2026
+
+author	Ziyi
+
+*****************************************************************************/
+
+#ifndef BOARD_LOG_H
+#define BOARD_LOG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*****************************************************************************
+ * Constants
+ */
+
+/** Frame type of a record batch on the display UART **/
+#define BOARD_LOG_FRAME				0x01
+
+/** Record buffer size in bytes, a full buffer is sent at once **/
+#ifndef BOARD_LOG_BUF_LEN
+#define BOARD_LOG_BUF_LEN			128
+#endif
+
+/** Most arguments of one record **/
+#define BOARD_LOG_MAX_ARGS			5
+
+/*****************************************************************************
+ * Macros
+ */
+
+/**
+ * Log site ID, the file ID in the top 4 bits and the source line in the
+ * rest. Every file with log sites defines BOARD_LOG_FILE_ID, unique in
+ * its app, before including board_display.h.
+ */
+#define BOARD_LOG_ID \
+	((uint16_t) (((BOARD_LOG_FILE_ID) << 12) | (__LINE__ & 0x0FFF)))
+
+/** Split a BLE address into two arguments, logged with "0x%04x%08x" **/
+#define BOARD_LOG_ADDR_HI(a) \
+	(((uint32_t) (a)[5] << 8) | (a)[4])
+#define BOARD_LOG_ADDR_LO(a) \
+	(((uint32_t) (a)[3] << 24) | ((uint32_t) (a)[2] << 16) \
+			| ((uint32_t) (a)[1] << 8) | (a)[0])
+
+/*****************************************************************************
+ * @fn      Board_Log_write
+ *
+ * @brief   Append a record to the buffer, sending the buffer first if the
+ 			record does not fit. Arguments are sent zigzag varint coded,
+ 			so small values of either sign take one byte.
+ *
+ * @param   id - log site ID, BOARD_LOG_ID
+ 			nArgs - number of arguments used, up to BOARD_LOG_MAX_ARGS
+ 			a0 .. a4 - arguments
+ *
+ * @return  none
+ */
+void Board_Log_write(uint16_t id, uint8_t nArgs, uintptr_t a0, uintptr_t a1,
+		uintptr_t a2, uintptr_t a3, uintptr_t a4);
+
+/*****************************************************************************
+ * @fn      Board_Log_flush
+ *
+ * @brief   Send the buffered records as one frame. Call from the app task
+ 			loop once the wakeup is handled, so the UART work is kept out
+ 			of the handlers.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Log_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_LOG_H */
@@ -0,0 +1,191 @@
+/*****************************************************************************
+
+ file	board_msgq.c
+
+ brief	This file contains the application message lanes. An app task
+ keeps one lane per priority and services the high lanes completely and
+ the low lanes within a budget on every wakeup, so bursts of low value
+ messages cannot delay connection handling. Each lane holds a bounded
+ number of messages so a burst cannot drain the heap the stack needs.
+
+ proj	EVRS
+
+ date	1019pm 19 Oct 2026
+
+ author	Ziyi
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * Includes
+ */
+
+#include <stddef.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "util.h"
+#include "board_msgq.h"
+
+/*********************************************************************
+ * Typedefs
+ */
+
+/* Queue record wrapping an app message */
+typedef struct
+{
+    Queue_Elem elem;
+    uint32_t stamp;		// enqueue time in RTOS clock ticks
+    uint8_t *pData;		// app message
+} boardMsgRec_t;
+
+/*********************************************************************
+ * Public Functions
+ */
+/*****************************************************************************
+ * @fn      Board_MsgQ_construct
+ *
+ * @brief   Set up an empty lane.
+ *
+ * @param   pLane - lane
+ maxDepth - most messages queued, 0 for no limit
+ *
+ * @return  none
+ */
+void Board_MsgQ_construct(boardMsgLane_t *pLane, uint16_t maxDepth) {
+	pLane->handle = Util_constructQueue(&pLane->queue);
+	pLane->maxDepth = maxDepth;
+
+	pLane->stats.count = 0;
+	pLane->stats.totalLatency = 0;
+	pLane->stats.maxLatency = 0;
+	pLane->stats.drops = 0;
+	pLane->stats.depth = 0;
+	pLane->stats.highWater = 0;
+}
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_enqueue
+ *
+ * @brief   Queue an ICall_malloc'd message and wake the owner task.
+ *
+ * @param   pLane - lane
+ sem - owner task semaphore
+ pMsg - message
+ *
+ * @return  true if queued
+ */
+bool Board_MsgQ_enqueue(boardMsgLane_t *pLane, ICall_Semaphore sem,
+		uint8_t *pMsg) {
+	boardMsgRec_t *pRec;
+	uint32_t key;
+
+	// Claim a place in the lane before touching the heap
+	key = Hwi_disable();
+	if (pLane->maxDepth != 0 && pLane->stats.depth >= pLane->maxDepth)
+	{
+		pLane->stats.drops++;
+		Hwi_restore(key);
+		return false;
+	}
+	pLane->stats.depth++;
+	if (pLane->stats.depth > pLane->stats.highWater)
+	{
+		pLane->stats.highWater = pLane->stats.depth;
+	}
+	Hwi_restore(key);
+
+	pRec = (boardMsgRec_t *) ICall_malloc(sizeof(boardMsgRec_t));
+	if (pRec == NULL)
+	{
+		key = Hwi_disable();
+		pLane->stats.depth--;
+		pLane->stats.drops++;
+		Hwi_restore(key);
+		return false;
+	}
+
+	pRec->stamp = Clock_getTicks();
+	pRec->pData = pMsg;
+
+	Queue_put(pLane->handle, &pRec->elem);
+
+	Semaphore_post(sem);
+
+	return true;
+}
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_service
+ *
+ * @brief   Hand queued messages to a handler in FIFO order and free them.
+ *
+ * @param   pLane - lane
+ pfnMsg - handler
+ budget - most messages to service, 0 for all
+ *
+ * @return  number of messages serviced
+ */
+uint8_t Board_MsgQ_service(boardMsgLane_t *pLane, boardMsgHandler_t pfnMsg,
+		uint8_t budget) {
+	uint8_t serviced = 0;
+
+	while ((budget == 0 || serviced < budget) && !Queue_empty(pLane->handle))
+	{
+		boardMsgRec_t *pRec = (boardMsgRec_t *) Queue_get(pLane->handle);
+		uint32_t latency = Clock_getTicks() - pRec->stamp;
+		uint8_t *pMsg = pRec->pData;
+		uint32_t key;
+
+		ICall_free(pRec);
+
+		key = Hwi_disable();
+		pLane->stats.depth--;
+		Hwi_restore(key);
+
+		pLane->stats.count++;
+		pLane->stats.totalLatency += latency;
+		if (latency > pLane->stats.maxLatency)
+		{
+			pLane->stats.maxLatency = latency;
+		}
+
+		pfnMsg(pMsg);
+		ICall_free(pMsg);
+		serviced++;
+	}
+
+	return serviced;
+}
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_pending
+ *
+ * @brief   Check whether a lane holds messages.
+ *
+ * @param   pLane - lane
+ *
+ * @return  true if not empty
+ */
+bool Board_MsgQ_pending(boardMsgLane_t *pLane) {
+	return !Queue_empty(pLane->handle);
+}
+
+/*****************************************************************************
+ * @fn      Board_MsgQ_getStats
+ *
+ * @brief   Copy the lane counters.
+ *
+ * @param   pLane - lane
+ pStats - destination
+ *
+ * @return  none
+ */
+void Board_MsgQ_getStats(boardMsgLane_t *pLane, boardMsgLaneStats_t *pStats) {
+	uint32_t key = Hwi_disable();
+
+	*pStats = pLane->stats;
+	Hwi_restore(key);
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+
+ file	board_telemetry.c
+
+ brief	This file contains the runtime memory telemetry. Samples are
+ taken on request only, nothing runs in the background.
+
+ proj	EVRS
+
+ date	1019pm 19 Oct 2026
+
+ author	Ziyi
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * Includes
+ */
+
+#include <string.h>
+
+#include "icall.h"
+#include "board_telemetry.h"
+
+/*********************************************************************
+ * Local Functions
+ */
+
+static uint8_t Board_Telemetry_put16(uint8_t *pBuf, uint32_t value);
+
+/*********************************************************************
+ * Public Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Telemetry_task
+ *
+ * @brief   Sample the stack usage of a task.
+ *
+ * @param   hTask - task
+ pMem - destination
+ *
+ * @return  none
+ */
+void Board_Telemetry_task(Task_Handle hTask, boardTaskMem_t *pMem) {
+	Task_Stat stat;
+
+	Task_stat(hTask, &stat);
+	pMem->stackSize = (uint16_t) stat.stackSize;
+	pMem->stackPeak = (uint16_t) stat.used;
+}
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_heap
+ *
+ * @brief   Sample the ICall heap usage.
+ *
+ * @param   pMem - destination
+ *
+ * @return  true if the heap manager keeps metrics
+ */
+bool Board_Telemetry_heap(boardHeapMem_t *pMem) {
+#ifdef HEAPMGR_METRICS
+	uint32_t blkMax, blkCnt, blkFree, memAlo, memMax, memUB;
+
+	ICall_getHeapMgrGetMetrics(&blkMax, &blkCnt, &blkFree, &memAlo, &memMax,
+			&memUB);
+	pMem->allocated = (uint16_t) memAlo;
+	pMem->peak = (uint16_t) memMax;
+	pMem->upperBound = (uint16_t) memUB;
+	pMem->blocks = (uint16_t) blkCnt;
+	pMem->freeBlocks = (uint16_t) blkFree;
+
+	return true;
+#else
+	memset(pMem, 0, sizeof(boardHeapMem_t));
+
+	return false;
+#endif
+}
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_packTask
+ *
+ * @brief   Pack a stack sample little endian.
+ *
+ * @param   pMem - sample
+ pBuf - destination
+ *
+ * @return  number of bytes written
+ */
+uint8_t Board_Telemetry_packTask(const boardTaskMem_t *pMem, uint8_t *pBuf) {
+	uint8_t len = 0;
+
+	len += Board_Telemetry_put16(&pBuf[len], pMem->stackSize);
+	len += Board_Telemetry_put16(&pBuf[len], pMem->stackPeak);
+
+	return len;
+}
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_packHeap
+ *
+ * @brief   Pack a heap sample little endian.
+ *
+ * @param   pMem - sample
+ pBuf - destination
+ *
+ * @return  number of bytes written
+ */
+uint8_t Board_Telemetry_packHeap(const boardHeapMem_t *pMem, uint8_t *pBuf) {
+	uint8_t len = 0;
+
+	len += Board_Telemetry_put16(&pBuf[len], pMem->allocated);
+	len += Board_Telemetry_put16(&pBuf[len], pMem->peak);
+	len += Board_Telemetry_put16(&pBuf[len], pMem->upperBound);
+	len += Board_Telemetry_put16(&pBuf[len], pMem->blocks);
+	len += Board_Telemetry_put16(&pBuf[len], pMem->freeBlocks);
+
+	return len;
+}
+
+/*********************************************************************
+ * Local Functions
+ */
+/*****************************************************************************
+ * @fn      Board_Telemetry_put16
+ *
+ * @brief   Write the low 16 bits of a value little endian.
+ *
+ * @param   pBuf - destination
+ value - value
+ *
+ * @return  number of bytes written
+ */
+static uint8_t Board_Telemetry_put16(uint8_t *pBuf, uint32_t value) {
+	pBuf[0] = (uint8_t) value;
+	pBuf[1] = (uint8_t) (value >> 8);
+
+	return 2;
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+
+file	board_telemetry.h
+
+brief	This file contains the runtime memory telemetry definitions and
+		prototypes. Task stack peaks come from Task_stat, ICall heap
+		usage from the heap manager metrics.
+
+proj	EVRS
+
+date	1019pm 19 Oct 2026
+
+author	Ziyi
+
+*****************************************************************************/
+
+#ifndef BOARD_TELEMETRY_H
+#define BOARD_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/sysbios/knl/Task.h>
+
+/*****************************************************************************
+ * Constants
+ */
+
+/** Packed lengths, see Board_Telemetry_packTask and _packHeap **/
+#define BOARD_TELEMETRY_TASK_LEN	4
+#define BOARD_TELEMETRY_HEAP_LEN	10
+
+/*****************************************************************************
+ * Typedefs
+ */
+
+/** Task stack usage in bytes **/
+typedef struct
+{
+    uint16_t stackSize;		// stack size
+    uint16_t stackPeak;		// most stack ever used
+} boardTaskMem_t;
+
+/** ICall heap usage, sizes in bytes **/
+typedef struct
+{
+    uint16_t allocated;		// in use now
+    uint16_t peak;			// most ever in use
+    uint16_t upperBound;	// highest heap offset ever touched
+    uint16_t blocks;		// blocks now, free and used
+    uint16_t freeBlocks;	// free blocks now, more means more fragmented
+} boardHeapMem_t;
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_task
+ *
+ * @brief   Sample the stack usage of a task. The peak relies on the stack
+ 			fill pattern, Task.initStackFlag must be left on.
+ *
+ * @param   hTask - task
+ 			pMem - destination
+ *
+ * @return  none
+ */
+void Board_Telemetry_task(Task_Handle hTask, boardTaskMem_t *pMem);
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_heap
+ *
+ * @brief   Sample the ICall heap usage.
+ *
+ * @param   pMem - destination, zeroed without HEAPMGR_METRICS
+ *
+ * @return  true if the heap manager keeps metrics
+ */
+bool Board_Telemetry_heap(boardHeapMem_t *pMem);
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_packTask
+ *
+ * @brief   Pack a stack sample little endian: size, peak.
+ *
+ * @param   pMem - sample
+ 			pBuf - destination, BOARD_TELEMETRY_TASK_LEN bytes
+ *
+ * @return  number of bytes written
+ */
+uint8_t Board_Telemetry_packTask(const boardTaskMem_t *pMem, uint8_t *pBuf);
+
+/*****************************************************************************
+ * @fn      Board_Telemetry_packHeap
+ *
+ * @brief   Pack a heap sample little endian: allocated, peak, upper
+ 			bound, blocks, free blocks.
+ *
+ * @param   pMem - sample
+ 			pBuf - destination, BOARD_TELEMETRY_HEAP_LEN bytes
+ *
+ * @return  number of bytes written
+ */
+uint8_t Board_Telemetry_packHeap(const boardHeapMem_t *pMem, uint8_t *pBuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_TELEMETRY_H */
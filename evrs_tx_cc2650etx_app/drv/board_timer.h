@@ -0,0 +1,152 @@
+/*****************************************************************************
+
+file	board_timer.h
+
+brief	This file contains the application timer wheel definitions and
+		prototypes. All application timeouts share one RTOS clock, their
+		callbacks run in the application task.
+
+proj	EVRS
+
+date	1019pm 19 Oct 2026
+
+author	Ziyi
+
+*****************************************************************************/
+
+#ifndef BOARD_TIMER_H
+#define BOARD_TIMER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/sysbios/knl/Clock.h>
+
+/*****************************************************************************
+ * Constants
+ */
+
+/** Wheel resolution in ms **/
+#ifndef BOARD_TIMER_TICK_MS
+#define BOARD_TIMER_TICK_MS			10
+#endif
+
+/** Number of wheel slots, must be a power of 2 **/
+#ifndef BOARD_TIMER_NUM_SLOTS
+#define BOARD_TIMER_NUM_SLOTS		64
+#endif
+
+/*****************************************************************************
+ * Typedefs
+ */
+
+/** Timer callback, runs in the task calling Board_Timer_process **/
+typedef void (*boardTimerCB_t)(UArg arg);
+
+/** Timer object, owned by the caller **/
+typedef struct boardTimer
+{
+    struct boardTimer *pNext;	// next timer in the same slot
+    struct boardTimer *pPrev;	// previous timer in the same slot
+    uint32_t expiry;			// wheel tick to fire at
+    uint32_t timeout;			// first expiry in wheel ticks
+    uint32_t period;			// reload in wheel ticks, 0 for one-shot
+    boardTimerCB_t pfnCB;		// callback
+    UArg arg;					// callback argument
+    uint8_t slot;				// slot the timer is linked in
+} boardTimer_t;
+
+/*****************************************************************************
+ * @fn      Board_Timer_init
+ *
+ * @brief   Initial the timer wheel.
+ *
+ * @param   pfnWake - called from the clock SWI when timers are due, it
+ 			must wake the task calling Board_Timer_process
+ *
+ * @return  none
+ */
+void Board_Timer_init(void (*pfnWake)(void));
+
+/*****************************************************************************
+ * @fn      Board_Timer_construct
+ *
+ * @brief   Set up a timer, the timer is left stopped.
+ *
+ * @param   pTimer - timer object
+ 			pfnCB - callback
+ 			timeout - first expiry in ms
+ 			period - reload in ms, 0 for one-shot
+ 			arg - callback argument
+ *
+ * @return  none
+ */
+void Board_Timer_construct(boardTimer_t *pTimer, boardTimerCB_t pfnCB,
+		uint32_t timeout, uint32_t period, UArg arg);
+
+/*****************************************************************************
+ * @fn      Board_Timer_start
+ *
+ * @brief   Arm a timer with its current timeout, restarting it if armed.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  none
+ */
+void Board_Timer_start(boardTimer_t *pTimer);
+
+/*****************************************************************************
+ * @fn      Board_Timer_restart
+ *
+ * @brief   Arm a timer with a new timeout.
+ *
+ * @param   pTimer - timer object
+ 			timeout - expiry in ms
+ *
+ * @return  none
+ */
+void Board_Timer_restart(boardTimer_t *pTimer, uint32_t timeout);
+
+/*****************************************************************************
+ * @fn      Board_Timer_stop
+ *
+ * @brief   Disarm a timer, safe on a stopped timer.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  none
+ */
+void Board_Timer_stop(boardTimer_t *pTimer);
+
+/*****************************************************************************
+ * @fn      Board_Timer_isActive
+ *
+ * @brief   Check whether a timer is armed.
+ *
+ * @param   pTimer - timer object
+ *
+ * @return  true if armed
+ */
+bool Board_Timer_isActive(boardTimer_t *pTimer);
+
+/*****************************************************************************
+ * @fn      Board_Timer_process
+ *
+ * @brief   Fire every due timer and re-arm the wheel clock. Call from
+ 			the application task loop after each wakeup.
+ *
+ * @param   void
+ *
+ * @return  none
+ */
+void Board_Timer_process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_TIMER_H */
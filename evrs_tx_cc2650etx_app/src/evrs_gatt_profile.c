@@ -37,7 +37,7 @@
  * CONSTANTS
  */
 
-#define SERVAPP_NUM_ATTR_SUPPORTED        17
+#define SERVAPP_NUM_ATTR_SUPPORTED        14
 
 /*********************************************************************
  * TYPEDEFS
@@ -110,16 +110,29 @@ static uint8 EVRSProfileDevIdUserDesp[10] = "Device Id";
 static uint8 EVRSProfileCmdProps = GATT_PROP_READ | GATT_PROP_WRITE;
 
 // Command BS Value
-static uint8 EVRSProfileCmd = 0;
+static uint8 EVRSProfileCmd[EVRSPROFILE_CMD_LEN] = { 0 };
 
 // EVRS Profile BS Command User Description
 static uint8 EVRSProfileCmdUserDesp[11] = "BS Command";
 
 // EVRS Profile User Data Properties
-static uint8 EVRSProfileDataProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static uint8 EVRSProfileDataProps = GATT_PROP_READ | GATT_PROP_WRITE
+		| GATT_PROP_NOTIFY;
 
-// User Data Value
-static uint8 EVRSProfileData = 0;
+// User Data Value, the last vote and its journal
+static uint8 EVRSProfileData[EVRSPROFILE_DATA_MAX_LEN] = { 0 };
+static uint8 EVRSProfileDataLen = EVRSPROFILE_DATA_LEN;
+
+// Copy of the data a long read is served from, taken at offset 0 so the
+// blobs of one read match even if a vote comes in between
+static uint8 EVRSProfileDataRead[EVRSPROFILE_DATA_MAX_LEN] = { 0 };
+static uint8 EVRSProfileDataReadLen = 0;
+
+// Last acknowledgement written to the data, see EVRSPROFILE_ACK_LEN
+static uint8 EVRSProfileAck[EVRSPROFILE_ACK_LEN] = { 0 };
+
+// User Data Client Characteristic Configuration, one per link
+static gattCharCfg_t *EVRSProfileDataConfig;
 
 // EVRS Profile User Data User Description
 static uint8 EVRSProfileDataUserDesp[10] = "User Data";
@@ -166,7 +179,7 @@ static gattAttribute_t EVRSProfileAttrTbl[SERVAPP_NUM_ATTR_SUPPORTED] = {
 
 		// BS Command Value
 		{ { ATT_BT_UUID_SIZE, EVRSProfileCmdUUID },
-		GATT_PERMIT_READ | GATT_PERMIT_WRITE, 0, &EVRSProfileCmd },
+		GATT_PERMIT_READ | GATT_PERMIT_WRITE, 0, EVRSProfileCmd },
 
 		// BS Command User Description
 		{ { ATT_BT_UUID_SIZE, charUserDescUUID },
@@ -178,7 +191,12 @@ static gattAttribute_t EVRSProfileAttrTbl[SERVAPP_NUM_ATTR_SUPPORTED] = {
 
 		// User Data Value
 		{ { ATT_BT_UUID_SIZE, EVRSProfileDataUUID },
-		GATT_PERMIT_READ | GATT_PERMIT_WRITE, 0, &EVRSProfileData },
+		GATT_PERMIT_READ | GATT_PERMIT_WRITE, 0, EVRSProfileData },
+
+		// User Data Configuration
+		{ { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+		GATT_PERMIT_READ | GATT_PERMIT_WRITE, 0,
+				(uint8 *) &EVRSProfileDataConfig },
 
 		// User Data User Description
 		{ { ATT_BT_UUID_SIZE, charUserDescUUID },
@@ -231,9 +249,15 @@ bStatus_t EVRSProfile_AddService(uint32 services) {
 	uint8 status;
 
 	// Allocate Client Characteristic Configuration table
+	EVRSProfileDataConfig = (gattCharCfg_t *) ICall_malloc(
+			sizeof(gattCharCfg_t) * linkDBNumConns);
+	if (EVRSProfileDataConfig == NULL)
+	{
+		return (bleMemAllocError);
+	}
 
 	// Initialize Client Characteristic Configuration attributes
-	//GATTServApp_InitCharCfg( INVALID_CONNHANDLE, EVRSProfileDataConfig );
+	GATTServApp_InitCharCfg(INVALID_CONNHANDLE, EVRSProfileDataConfig);
 
 	if (services & EVRSPROFILE_SERVICE)
 	{
@@ -310,9 +334,9 @@ bStatus_t EVRSProfile_SetParameter(uint8 param, uint8 len, void *value) {
 			break;
 
 		case EVRSPROFILE_CMD:
-			if (len == sizeof(uint8))
+			if (len == EVRSPROFILE_CMD_LEN)
 			{
-				EVRSProfileCmd = *((uint8*) value);
+				memcpy(EVRSProfileCmd, value, EVRSPROFILE_CMD_LEN);
 			} else
 			{
 				ret = bleInvalidRange;
@@ -320,9 +344,23 @@ bStatus_t EVRSProfile_SetParameter(uint8 param, uint8 len, void *value) {
 			break;
 
 		case EVRSPROFILE_DATA:
-			if (len == sizeof(uint8))
+			if (len >= EVRSPROFILE_DATA_LEN && len <= EVRSPROFILE_DATA_MAX_LEN)
 			{
-				EVRSProfileData = *((uint8*) value);
+				// A new vote record is pushed to the subscribed links, a
+				// shorter journal alone is not
+				bool newVote = (memcmp(EVRSProfileData, value,
+						EVRSPROFILE_DATA_LEN) != 0);
+
+				memcpy(EVRSProfileData, value, len);
+				EVRSProfileDataLen = len;
+
+				if (newVote)
+				{
+					GATTServApp_ProcessCharCfg(EVRSProfileDataConfig,
+							EVRSProfileData, FALSE, EVRSProfileAttrTbl,
+							GATT_NUM_ATTRS(EVRSProfileAttrTbl),
+							INVALID_TASK_ID, EVRSProfile_ReadAttrCB);
+				}
 			} else
 			{
 				ret = bleInvalidRange;
@@ -363,11 +401,16 @@ bStatus_t EVRSProfile_GetParameter(uint8 param, void *value) {
 			break;
 
 		case EVRSPROFILE_CMD:
-			*((uint8*) value) = EVRSProfileCmd;
+			memcpy(value, EVRSProfileCmd, EVRSPROFILE_CMD_LEN);
 			break;
 
 		case EVRSPROFILE_DATA:
-			*((uint8*) value) = EVRSProfileData;
+			// The last vote record, without the journal
+			memcpy(value, EVRSProfileData, EVRSPROFILE_DATA_LEN);
+			break;
+
+		case EVRSPROFILE_ACK:
+			memcpy(value, EVRSProfileAck, EVRSPROFILE_ACK_LEN);
 			break;
 
 		default:
@@ -398,16 +441,17 @@ static bStatus_t EVRSProfile_ReadAttrCB(uint16_t connHandle,
 		uint16_t offset, uint16_t maxLen, uint8_t method) {
 	bStatus_t status = SUCCESS;
 
-	// Make sure it's not a blob operation (no attributes in the profile are long)
-	if (offset > 0)
-	{
-		return ( ATT_ERR_ATTR_NOT_LONG);
-	}
-
 	if (pAttr->type.len == ATT_BT_UUID_SIZE)
 	{
 		// 16-bit UUID
 		uint16 uuid = BUILD_UINT16(pAttr->type.uuid[0], pAttr->type.uuid[1]);
+
+		// Make sure it's not a blob operation, only the data is long
+		if (offset > 0 && uuid != EVRSPROFILE_DATA_UUID)
+		{
+			return ( ATT_ERR_ATTR_NOT_LONG);
+		}
+
 		switch (uuid)
 		{
 			// No need for "GATT_SERVICE_UUID" or "GATT_CLIENT_CHAR_CFG_UUID" cases;
@@ -415,12 +459,48 @@ static bStatus_t EVRSProfile_ReadAttrCB(uint16_t connHandle,
 
 			case EVRSPROFILE_SYSID_UUID:
 			case EVRSPROFILE_DEVID_UUID:
-			case EVRSPROFILE_CMD_UUID:
-			case EVRSPROFILE_DATA_UUID:
 				*pLen = 1;
 				pValue[0] = *pAttr->pValue;
 				break;
 
+			case EVRSPROFILE_DATA_UUID:
+				// A notification, read locally by GATTServApp_ProcessCharCfg,
+				// carries the vote record and the journal length, the
+				// client reads the journal if it is not empty
+				if (method == GATT_LOCAL_READ)
+				{
+					*pLen = EVRSPROFILE_DATA_JOURNAL_IDX + 1;
+					memcpy(pValue, EVRSProfileData, *pLen);
+					break;
+				}
+
+				// Serve the record and journal from offset on, as much as
+				// fits, out of the copy taken when the read started
+				if (offset == 0)
+				{
+					memcpy(EVRSProfileDataRead, EVRSProfileData,
+							EVRSProfileDataLen);
+					EVRSProfileDataReadLen = EVRSProfileDataLen;
+				}
+				if (offset > EVRSProfileDataReadLen)
+				{
+					*pLen = 0;
+					status = ATT_ERR_INVALID_OFFSET;
+					break;
+				}
+				*pLen = EVRSProfileDataReadLen - offset;
+				if (*pLen > maxLen)
+				{
+					*pLen = maxLen;
+				}
+				memcpy(pValue, EVRSProfileDataRead + offset, *pLen);
+				break;
+
+			case EVRSPROFILE_CMD_UUID:
+				*pLen = EVRSPROFILE_CMD_LEN;
+				memcpy(pValue, pAttr->pValue, EVRSPROFILE_CMD_LEN);
+				break;
+
 			default:
 				// Should never get here! (characteristics 3 and 4 do not have read permissions)
 				*pLen = 0;
@@ -463,9 +543,30 @@ static bStatus_t EVRSProfile_WriteAttrCB(uint16_t connHandle,
 		uint16 uuid = BUILD_UINT16(pAttr->type.uuid[0], pAttr->type.uuid[1]);
 		switch (uuid)
 		{
-			case EVRSPROFILE_DEVID_UUID:
 			case EVRSPROFILE_CMD_UUID:
-			case EVRSPROFILE_DATA_UUID:
+
+				//Validate the value
+				// Make sure it's not a blob oper
+				if (offset == 0)
+				{
+					if (len != EVRSPROFILE_CMD_LEN)
+					{
+						status = ATT_ERR_INVALID_VALUE_SIZE;
+					}
+				} else
+				{
+					status = ATT_ERR_ATTR_NOT_LONG;
+				}
+
+				//Write the value
+				if (status == SUCCESS)
+				{
+					memcpy(pAttr->pValue, pValue, EVRSPROFILE_CMD_LEN);
+					notifyApp = EVRSPROFILE_CMD;
+				}
+				break;
+
+			case EVRSPROFILE_DEVID_UUID:
 
 				//Validate the value
 				// Make sure it's not a blob oper
@@ -483,18 +584,58 @@ static bStatus_t EVRSProfile_WriteAttrCB(uint16_t connHandle,
 				//Write the value
 				if (status == SUCCESS)
 				{
-					uint8 *pCurValue = (uint8 *)pAttr->pValue;
-					*pCurValue = pValue[0];
-
-					if (pAttr->pValue == &EVRSProfileDevId)
-						notifyApp = EVRSPROFILE_DEVID;
-					else if (pAttr->pValue == &EVRSProfileCmd)
-						notifyApp = EVRSPROFILE_CMD;
-					else
-						notifyApp = EVRSPROFILE_DATA;
+					EVRSProfileDevId = pValue[0];
+					notifyApp = EVRSPROFILE_DEVID;
+				}
+				break;
+
+			case EVRSPROFILE_DATA_UUID:
+
+				//Validate the acknowledgement, a bare mark or the header
+				//and whole commands
+				// Make sure it's not a blob oper
+				if (offset == 0)
+				{
+					if (len != 1 && (len < EVRSPROFILE_ACK_HDR_LEN
+							|| len > EVRSPROFILE_ACK_LEN
+							|| (len - EVRSPROFILE_ACK_HDR_LEN)
+									% EVRSPROFILE_CMD_LEN != 0))
+					{
+						status = ATT_ERR_INVALID_VALUE_SIZE;
+					} else if (pValue[0] != EVRSPROFILE_ACK_MARK)
+					{
+						status = ATT_ERR_INVALID_VALUE;
+					}
+				} else
+				{
+					status = ATT_ERR_ATTR_NOT_LONG;
+				}
+
+				//Keep the acknowledgement, the data keeps its vote. A
+				//bare mark acknowledges the vote held now.
+				if (status == SUCCESS)
+				{
+					memset(EVRSProfileAck, 0, EVRSPROFILE_ACK_LEN);
+					if (len == 1)
+					{
+						EVRSProfileAck[0] = EVRSPROFILE_ACK_MARK;
+						EVRSProfileAck[1] =
+								EVRSProfileData[EVRSPROFILE_DATA_SEQ_IDX];
+						EVRSProfileAck[2] =
+								EVRSProfileData[EVRSPROFILE_DATA_SEQ_IDX + 1];
+					} else
+					{
+						memcpy(EVRSProfileAck, pValue, len);
+					}
+					notifyApp = EVRSPROFILE_DATA;
 				}
 				break;
 
+			case GATT_CLIENT_CHAR_CFG_UUID:
+				status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr,
+						pValue, len, offset, GATT_CLIENT_CFG_NOTIFY);
+				break;
+
 			default:
 				// Should never get here! (characteristics 2 and 4 do not have write permissions)
 				status = ATT_ERR_ATTR_NOT_FOUND;
@@ -32,8 +32,56 @@ extern "C"
 // Profile Parameters
 #define EVRSPROFILE_SYSID				0x00  // RW uint8
 #define EVRSPROFILE_DEVID				0x01  // RW uint8
-#define EVRSPROFILE_CMD				0x02  // RW uint8
-#define EVRSPROFILE_DATA				0x03  // RW uint8
+#define EVRSPROFILE_CMD				0x02  // RW uint8[EVRSPROFILE_CMD_LEN]
+#define EVRSPROFILE_DATA				0x03  // RW uint8[EVRSPROFILE_DATA_LEN..EVRSPROFILE_DATA_MAX_LEN]
+#define EVRSPROFILE_ACK				0x04  // R  uint8[EVRSPROFILE_ACK_LEN], last DATA write
+
+// Command length, [opcode, arg]
+#define EVRSPROFILE_CMD_LEN			2
+
+// Data record, little endian:
+// [vote, vote sequence u16, epoch, version, cast time u32, battery u16]
+// The sequence goes up by one on every vote, the epoch is the base
+// station question the vote was cast in. Version EVRSPROFILE_DATA_VER
+// adds the Tx uptime in ms when the vote was cast and the battery in mV.
+// Later versions only append, older readers use the prefix they know.
+// Long (blob) reads are served.
+// Version 2 appends the journal of older votes not acknowledged yet:
+// [record of the last vote, n, record * n], oldest first.
+// With notifications enabled every new vote is pushed as [record, n],
+// a client seeing n > 0 reads the journal before acknowledging.
+#define EVRSPROFILE_DATA_LEN		11
+#define EVRSPROFILE_DATA_VER		2
+#define EVRSPROFILE_DATA_VOTE_IDX	0
+#define EVRSPROFILE_DATA_SEQ_IDX	1
+#define EVRSPROFILE_DATA_EPOCH_IDX	3
+#define EVRSPROFILE_DATA_VER_IDX	4
+#define EVRSPROFILE_DATA_TIME_IDX	5
+#define EVRSPROFILE_DATA_BATT_IDX	9
+#define EVRSPROFILE_DATA_JOURNAL_IDX	EVRSPROFILE_DATA_LEN
+#define EVRSPROFILE_JOURNAL_MAX		7
+#define EVRSPROFILE_DATA_MAX_LEN	(EVRSPROFILE_DATA_LEN + 1 \
+		+ EVRSPROFILE_JOURNAL_MAX * EVRSPROFILE_DATA_LEN)
+
+// Vote values, option n of a question is EVRSPROFILE_VOTE_FIRST + n.
+// Every vote steps to the next option and wraps after the last.
+#define EVRSPROFILE_VOTE_FIRST		0xA5
+#define EVRSPROFILE_VOTE_NUM_OPTIONS	16
+
+// Vote value of the record served before the first vote. A base station
+// acknowledges it but does not forward or count it.
+#define EVRSPROFILE_VOTE_NONE		0xA4
+
+// A DATA write is the base station acknowledging the data, with the
+// commands it has for this Tx piggybacked:
+// [0xFF, acked vote sequence u16, (opcode, arg) * n]. A bare 0xFF, as
+// older base stations write, acknowledges the current vote. The ACK
+// parameter holds the last one, zero padded, opcode 0 ends the list.
+#define EVRSPROFILE_ACK_MARK		0xFF
+#define EVRSPROFILE_ACK_HDR_LEN		3
+#define EVRSPROFILE_ACK_MAX_CMDS	4
+#define EVRSPROFILE_ACK_LEN			(EVRSPROFILE_ACK_HDR_LEN \
+		+ EVRSPROFILE_ACK_MAX_CMDS * EVRSPROFILE_CMD_LEN)
 
 // EVRS Profile Service UUID
 #define EVRSPROFILE_SERV_UUID       	0xAFF0
@@ -48,6 +48,9 @@
 /*********************************************************************
  * INCLUDES
  */
+// Log site file ID, see board_log.h
+#define BOARD_LOG_FILE_ID		1
+
 #include <string.h>
 
 #include <ti/sysbios/knl/Task.h>
@@ -77,10 +80,15 @@
 
 #include "board_key.h"
 #include "board_led.h"
+#include "board_timer.h"
+#include "board_msgq.h"
+#include "board_telemetry.h"
 #include "board_display.h"
 
 #include "board.h"
 
+#include <driverlib/aon_batmon.h>
+
 #include "evrs_tx_main.h"
 
 /*********************************************************************
@@ -119,6 +127,9 @@
 // How often to perform periodic event (in msec)
 #define ETX_PERIODIC_EVT_PERIOD               5000
 
+// Memory telemetry report period in ms, kept long to save power
+#define ETX_TELEMETRY_PERIOD                  30000
+
 // Task configuration
 #define ETX_TASK_PRIORITY                     1
 
@@ -128,6 +139,8 @@
 
 #define ETX_ADTYPE_DEST				0xAF
 #define ETX_ADTYPE_DEVID			0xAE
+#define ETX_ADTYPE_DVER				0xAD
+#define ETX_ADTYPE_BCAST			0xAC	// base station command broadcast
 
 // Application state
 typedef enum {
@@ -140,11 +153,54 @@ typedef enum {
 #define ETX_PERIODIC_EVT                      0x0004
 #define ETX_CONN_EVT_END_EVT                  0x0008
 #define ETX_KEY_CHANGE_EVT                    0x0010
+#define ETX_BCAST_EVT                         0x0020
+
+// Most low lane app messages serviced per wakeup
+#define ETX_LOW_LANE_BUDGET                   2
+
+// Most app messages queued per lane, each one holds ICall heap
+#define ETX_HIGH_LANE_DEPTH                   8
+#define ETX_LOW_LANE_DEPTH                    4
 
 #define ETX_DEVID_LEN 			4
 #define ETX_DEVID_NV_ID			0x80
 #define ETX_DEVID_PREFIX		0x95
 
+// Output power commanded by the base station, int8 dBm
+#define ETX_TXPWR_NV_ID			0x81
+
+// Last vote sequence number, uint16, kept so it never goes back
+#define ETX_VOTESEQ_NV_ID		0x82
+
+// Question epoch set by the base station, uint8
+#define ETX_EPOCH_NV_ID			0x83
+
+// Index of the power level byte in scanRspData
+#define ETX_SCANRSP_TXPWR_IDX	8
+
+// Base station commands, [opcode, arg] in the CMD characteristic or
+// piggybacked on the DATA acknowledgement
+#define ETX_CMD_OP_NONE			0x00	// ends the acknowledgement commands
+#define ETX_CMD_OP_TXPWR		0x01	// arg: output power in dBm, int8
+#define ETX_CMD_OP_EPOCH		0x02	// arg: question epoch, stamped into votes
+
+// Base station command broadcast, ETX_ADTYPE_BCAST value
+// [bsID, seq, epoch, op, arg], applied once as if written to CMD
+#define ETX_BCAST_LEN			5
+#define ETX_BCAST_BSID_IDX		0
+#define ETX_BCAST_SEQ_IDX		1
+#define ETX_BCAST_EPOCH_IDX		2
+
+// Observe window for command broadcasts, a scan of ETX_OBSERVE_WINDOW
+// ms every ETX_OBSERVE_PERIOD ms while not connected. The window spans
+// one advertising interval of the base station burst.
+#ifndef ETX_OBSERVE_PERIOD
+#define ETX_OBSERVE_PERIOD		2000
+#endif
+#ifndef ETX_OBSERVE_WINDOW
+#define ETX_OBSERVE_WINDOW		110
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -152,8 +208,16 @@ typedef enum {
 // App event passed from profiles.
 typedef struct {
 	appEvtHdr_t hdr;  // event header.
+	uint8_t *pData;   // event data, freed with the message
 } sbpEvt_t;
 
+// App message lanes, in service order
+typedef enum {
+	ETX_LANE_HIGH,	// role state and characteristic writes
+	ETX_LANE_LOW,	// keys
+	ETX_NUM_LANES
+} etxLane_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -173,12 +237,24 @@ static ICall_Semaphore sem;
 //static Clock_Struct periodicClock;
 
 // Queue object used for app messages
-static Queue_Struct appMsg;
-static Queue_Handle appMsgQueue;
+static boardMsgLane_t appLanes[ETX_NUM_LANES];
 
 // events flag for internal application events.
 static uint16_t events = 0;
 
+// Memory telemetry report timer
+static boardTimer_t telemetryTmr;
+
+#ifdef PLUS_OBSERVER
+// Command broadcast observe window timer
+static boardTimer_t observeTmr;
+
+// Last broadcast taken from seq on, repeats of it are skipped. Only
+// touched in the GAP role task.
+static uint8_t bcastLast[ETX_BCAST_LEN - ETX_BCAST_SEQ_IDX];
+static bool bcastHeard = FALSE;
+#endif // PLUS_OBSERVER
+
 // Task configuration
 Task_Struct sbpTask;
 Char sbpTaskStack[ETX_TASK_STACK_SIZE];
@@ -204,6 +280,12 @@ static uint8_t advertData[] = {
 
 		0x02,
 		ETX_ADTYPE_DEST,
+		0x00,
+
+		// data version, bumped on every vote so the base station only
+		// polls transmitters with new data
+		0x02,
+		ETX_ADTYPE_DVER,
 		0x00
 };
 
@@ -245,9 +327,38 @@ static uint8_t rspTxRetry = 0;
 // Destiny base station ID
 static uint8_t destBsID = 0x00;
 
+// Version of the data characteristic, wraps at 0xFF. Goes up with
+// voteSeq, so it carries on over a reset.
+static uint8_t dataVer = 0x00;
+
+// Sequence number of the last vote, lets the base station drop votes
+// it has already forwarded
+static uint16_t voteSeq = 0;
+
+// Question epoch of the base station, votes from an older one are stale
+static uint8_t voteEpoch = 0;
+
+// Votes older than the last one the base station has not acknowledged,
+// oldest at journal[journalHead]. A full journal drops its oldest vote.
+static uint8_t journal[EVRSPROFILE_JOURNAL_MAX][EVRSPROFILE_DATA_LEN];
+static uint8_t journalHead = 0;
+static uint8_t journalCount = 0;
+static uint16_t journalDrops = 0;
+
+// Last vote acknowledged, it joins the journal when replaced if not
+static bool voteAcked = TRUE;
+
 // device ID params about Flash
 static uint8_t devID[ETX_DEVID_LEN] = {0};
 
+// Output power in dBm
+static int8_t txPower = 0;
+
+// Output power levels in dBm, indexed by HCI_EXT_TX_POWER_*
+static const int8_t txPowerLevels[] = {
+	-21, -18, -15, -12, -9, -6, -3, 0, 1, 2, 3, 4, 5
+};
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -258,6 +369,7 @@ static void ETX_taskFxn(UArg a0, UArg a1);
 static uint8_t ETX_processStackMsg(ICall_Hdr *pMsg);
 static uint8_t ETX_processGATTMsg(gattMsgEvent_t *pMsg);
 static void ETX_processAppMsg(sbpEvt_t *pMsg);
+static void ETX_serviceAppMsg(uint8_t *pMsg);
 static void ETX_processStateChangeEvt(gaprole_States_t newState);
 static void ETX_processCharValueChangeEvt(uint8_t paramID);
 //static void ETX_performPeriodicTask(void);
@@ -270,16 +382,29 @@ static void ETX_stateChangeCB(gaprole_States_t newState);
 #ifndef FEATURE_OAD_ONCHIP
 static void ETX_charValueChangeCB(uint8_t paramID);
 #endif //!FEATURE_OAD_ONCHIP
-static void ETX_enqueueMsg(uint8_t event, uint8_t state);
+static bool ETX_enqueueMsg(uint8_t event, uint8_t state, uint8_t *pData);
+static void ETX_applyCmd(uint8_t op, uint8_t arg);
+static uint16_t ETX_Batt_read(void);
+static void ETX_Journal_add(const uint8_t *pRec);
+static void ETX_Journal_reclaim(uint16_t ackSeq);
+static void ETX_Journal_publish(const uint8_t *pRec);
+#ifdef PLUS_OBSERVER
+static void ETX_observerCB(gapPeripheralObserverRoleEvent_t *pEvent);
+static void ETX_observe(UArg a0);
+#endif // PLUS_OBSERVER
 
 void ETX_keyChangeHandler(uint8_t keys);
+static void ETX_timerWakeHandler(void);
 static void ETX_handleKeys(uint8_t shift, uint8_t keys);
+static void ETX_reportTelemetry(UArg a0);
 
 //device id
 static void ETX_DevId_Find(uint8_t* nvBuf);
 static void ETX_DevId_Refresh(uint8_t IdPrefix, uint8_t* nvBuf);
 static void ETX_ScanRsp_UpdateDeviceID();
 static void ETX_Advert_UpdateDestinyBS();
+static void ETX_Advert_UpdateDataVer();
+static bool ETX_TxPower_Set(int8_t dbm);
 
 /*********************************************************************
  * EXTERN FUNCTIONS
@@ -292,7 +417,10 @@ extern void AssertHandler(uint8 assertCause, uint8 assertSubcause);
 
 // GAP Role Callbacks
 static gapRolesCBs_t ETX_gapRoleCBs = {
-		ETX_stateChangeCB     // Profile State Change Callbacks
+		ETX_stateChangeCB,    // Profile State Change Callbacks
+#ifdef PLUS_OBSERVER
+		ETX_observerCB        // Command broadcasts heard
+#endif // PLUS_OBSERVER
 		};
 
 // GAP Bond Manager Callbacks
@@ -356,12 +484,27 @@ static void ETX_init(void) {
 #endif // USE_RCOSC
 
 	// Create an RTOS queue for message from profile to be sent to app.
-	appMsgQueue = Util_constructQueue(&appMsg);
+	Board_MsgQ_construct(&appLanes[ETX_LANE_HIGH], ETX_HIGH_LANE_DEPTH);
+	Board_MsgQ_construct(&appLanes[ETX_LANE_LOW], ETX_LOW_LANE_DEPTH);
+
+	// App timers share one RTOS clock and fire in this task
+	Board_Timer_init(ETX_timerWakeHandler);
 
 	Board_initKeys(ETX_keyChangeHandler);
 	Board_initLEDs();
 	Board_Display_Init();
 
+	// Print stack, heap and queue usage now and then
+	Board_Timer_construct(&telemetryTmr, ETX_reportTelemetry,
+	ETX_TELEMETRY_PERIOD, ETX_TELEMETRY_PERIOD, 0);
+	Board_Timer_start(&telemetryTmr);
+
+#ifdef PLUS_OBSERVER
+	// Listen for command broadcasts now and then
+	Board_Timer_construct(&observeTmr, ETX_observe, ETX_OBSERVE_PERIOD,
+			ETX_OBSERVE_PERIOD, 0);
+	Board_Timer_start(&observeTmr);
+#endif // PLUS_OBSERVER
 
 	// Device ID check
 	{
@@ -371,6 +514,35 @@ static void ETX_init(void) {
 			ETX_ScanRsp_UpdateDeviceID();
 	}
 
+	// Output power check
+	{
+		int8_t nvPower;
+
+		if (osal_snv_read(ETX_TXPWR_NV_ID, sizeof(nvPower),
+				(uint8 *) &nvPower) == SUCCESS)
+			ETX_TxPower_Set(nvPower);
+	}
+
+	// Vote sequence check, carry on from the last vote before the reset
+	if (osal_snv_read(ETX_VOTESEQ_NV_ID, sizeof(voteSeq),
+			(uint8 *) &voteSeq) != SUCCESS)
+	{
+		voteSeq = 0;
+	}
+
+	// A base station may still hold the version acknowledged before the
+	// reset, restarting from 0 could hit it again and hide new votes
+	dataVer = LO_UINT16(voteSeq);
+	advertData[12] = dataVer;
+	if (osal_snv_read(ETX_EPOCH_NV_ID, sizeof(voteEpoch),
+			(uint8 *) &voteEpoch) != SUCCESS)
+	{
+		voteEpoch = 0;
+	}
+
+	// Battery monitor, sampled into every vote
+	AONBatMonEnable();
+
 	// Setup the GAP
 	GAP_SetParamValue(TGAP_CONN_PAUSE_PERIPHERAL, CONN_PAUSE_PERIPHERAL);
 
@@ -458,17 +630,23 @@ static void ETX_init(void) {
 	{
 		uint8_t sysIdVal = 0xA1;
 		uint8_t devIdVal = 0xA2;
-		uint8_t cmdVal = 0xA3;
-		uint8_t dataVal = 0xA4;
+		uint8_t cmdVal[EVRSPROFILE_CMD_LEN] = { 0 };
+		uint8_t dataVal[EVRSPROFILE_DATA_LEN] = { 0 };
 
 		EVRSProfile_SetParameter(EVRSPROFILE_SYSID, sizeof(sysIdVal),
 				&sysIdVal);
 		EVRSProfile_SetParameter(EVRSPROFILE_DEVID, sizeof(devIdVal),
 				&devIdVal);
 		EVRSProfile_SetParameter(EVRSPROFILE_CMD, sizeof(cmdVal),
-				&cmdVal);
-		EVRSProfile_SetParameter(EVRSPROFILE_DATA, sizeof(dataVal),
-				&dataVal);
+				cmdVal);
+
+		// No vote yet, the record carries on from the last sequence
+		dataVal[EVRSPROFILE_DATA_VOTE_IDX] = EVRSPROFILE_VOTE_NONE;
+		dataVal[EVRSPROFILE_DATA_SEQ_IDX] = LO_UINT16(voteSeq);
+		dataVal[EVRSPROFILE_DATA_SEQ_IDX + 1] = HI_UINT16(voteSeq);
+		dataVal[EVRSPROFILE_DATA_EPOCH_IDX] = voteEpoch;
+		dataVal[EVRSPROFILE_DATA_VER_IDX] = EVRSPROFILE_DATA_VER;
+		ETX_Journal_publish(dataVal);
 	}
 
 	// Register callback with SimpleGATTprofile
@@ -552,18 +730,15 @@ static void ETX_taskFxn(UArg a0, UArg a1) {
 				}
 			}
 
-			// If RTOS queue is not empty, process app message.
-			while (!Queue_empty(appMsgQueue))
-			{
-				sbpEvt_t *pMsg = (sbpEvt_t *) Util_dequeueMsg(appMsgQueue);
-				if (pMsg)
-				{
-					// Process message.
-					ETX_processAppMsg(pMsg);
+			// Role and characteristic events first, then a few keys
+			Board_MsgQ_service(&appLanes[ETX_LANE_HIGH], ETX_serviceAppMsg, 0);
+			Board_MsgQ_service(&appLanes[ETX_LANE_LOW], ETX_serviceAppMsg,
+					ETX_LOW_LANE_BUDGET);
 
-					// Free the space from the message.
-					ICall_free(pMsg);
-				}
+			// Come back for the rest once the stack had its turn
+			if (Board_MsgQ_pending(&appLanes[ETX_LANE_LOW]))
+			{
+				Semaphore_post(sem);
 			}
 		}
 
@@ -577,6 +752,11 @@ static void ETX_taskFxn(UArg a0, UArg a1) {
 			//ETX_performPeriodicTask();
 		}
 
+		// Fire the app timers that are due
+		Board_Timer_process();
+
+		// Send the log records of this wakeup in one frame
+		Board_Log_flush();
 	}
 }
 
@@ -661,12 +841,12 @@ static uint8_t ETX_processGATTMsg(gattMsgEvent_t *pMsg) {
 		// The app is informed in case it wants to drop the connection.
 
 		// Display the opcode of the message that caused the violation.
-		uout1("FC Violated: %d",
+		ulog1(WARN, "FC Violated: %d",
 				pMsg->msg.flowCtrlEvt.opcode);
 	} else if (pMsg->method == ATT_MTU_UPDATED_EVENT)
 	{
 		// MTU size updated
-		uout1("MTU Size: $d", pMsg->msg.mtuEvt.MTU);
+		uout1("MTU Size: %d", pMsg->msg.mtuEvt.MTU);
 	}
 
 	// Free message payload. Needed only for ATT Protocol messages
@@ -708,7 +888,7 @@ static void ETX_sendAttRsp(void) {
 		} else
 		{
 			// Continue retrying
-			uout1("Rsp send retry: %d", rspTxRetry);
+			ulog1(DEBUG, "Rsp send retry: %d", rspTxRetry);
 		}
 	}
 }
@@ -729,13 +909,13 @@ static void ETX_freeAttRsp(uint8_t status) {
 		// See if the response was sent out successfully
 		if (status == SUCCESS)
 		{
-			uout1("Rsp sent retry: %d", rspTxRetry);
+			ulog1(DEBUG, "Rsp sent retry: %d", rspTxRetry);
 		} else
 		{
 			// Free response payload
 			GATT_bm_free(&pAttRsp->msg, pAttRsp->method);
 
-			uout1("Rsp retry failed: %d",
+			ulog1(WARN, "Rsp retry failed: %d",
 					rspTxRetry);
 		}
 
@@ -748,6 +928,19 @@ static void ETX_freeAttRsp(uint8_t status) {
 	}
 }
 
+/*********************************************************************
+ * @fn      ETX_serviceAppMsg
+ *
+ * @brief   App message lane handler.
+ *
+ * @param   pMsg - queued sbpEvt_t, freed by the lane
+ *
+ * @return  None.
+ */
+static void ETX_serviceAppMsg(uint8_t *pMsg) {
+	ETX_processAppMsg((sbpEvt_t *) pMsg);
+}
+
 /*********************************************************************
  * @fn      ETX_processAppMsg
  *
@@ -771,11 +964,24 @@ static void ETX_processAppMsg(sbpEvt_t *pMsg) {
 
 		case ETX_KEY_CHANGE_EVT:
 			ETX_handleKeys(0, pMsg->hdr.state);
+			break;
+
+		case ETX_BCAST_EVT:
+			// The epoch first, then the command itself
+			uout2("BS Bcast: 0x%02x 0x%02x", pMsg->pData[1], pMsg->pData[2]);
+			ETX_applyCmd(ETX_CMD_OP_EPOCH, pMsg->pData[0]);
+			ETX_applyCmd(pMsg->pData[1], pMsg->pData[2]);
+			break;
 
 		default:
 			// Do nothing.
 			break;
 	}
+
+	if (pMsg->pData != NULL)
+	{
+		ICall_free(pMsg->pData);
+	}
 }
 
 /*********************************************************************
@@ -788,7 +994,7 @@ static void ETX_processAppMsg(sbpEvt_t *pMsg) {
  * @return  None.
  */
 static void ETX_stateChangeCB(gaprole_States_t newState) {
-	ETX_enqueueMsg(ETX_STATE_CHANGE_EVT, newState);
+	ETX_enqueueMsg(ETX_STATE_CHANGE_EVT, newState, NULL);
 }
 
 /*********************************************************************
@@ -834,7 +1040,8 @@ static void ETX_processStateChangeEvt(gaprole_States_t newState) {
 			appState = APP_STATE_IDLE;
 
 			// Display device address
-			uout0(Util_convertBdAddr2Str(ownAddress));
+			uout2("Own Addr 0x%04x%08x", BOARD_LOG_ADDR_HI(ownAddress),
+					BOARD_LOG_ADDR_LO(ownAddress));
 			uout0("Initialized");
 			Board_ledControl(BOARD_LED_ID_R, BOARD_LED_STATE_OFF, 0);
 
@@ -889,7 +1096,8 @@ static void ETX_processStateChangeEvt(gaprole_States_t newState) {
 			if (linkDB_GetInfo(numActive - 1, &linkInfo) == SUCCESS)
 			{
 				uout1("Num Conns: %d", (uint16_t )numActive);
-				uout0(Util_convertBdAddr2Str(linkInfo.addr));
+				uout2("Peer Addr 0x%04x%08x", BOARD_LOG_ADDR_HI(linkInfo.addr),
+						BOARD_LOG_ADDR_LO(linkInfo.addr));
 			} else
 			{
 				uint8_t peerAddress[B_ADDR_LEN];
@@ -897,7 +1105,8 @@ static void ETX_processStateChangeEvt(gaprole_States_t newState) {
 				GAPRole_GetParameter(GAPROLE_CONN_BD_ADDR, peerAddress);
 
 				uout0("Connected");
-				uout0(Util_convertBdAddr2Str(peerAddress));
+				uout2("Peer Addr 0x%04x%08x", BOARD_LOG_ADDR_HI(peerAddress),
+						BOARD_LOG_ADDR_LO(peerAddress));
 			}
 			Board_ledControl(BOARD_LED_ID_R, BOARD_LED_STATE_FLASH, 500);
 
@@ -955,7 +1164,7 @@ static void ETX_processStateChangeEvt(gaprole_States_t newState) {
 			break;
 
 		case GAPROLE_ERROR:
-			uout0("Error");
+			ulog0(ERR, "Error");
 			break;
 
 		default:
@@ -976,7 +1185,7 @@ static void ETX_processStateChangeEvt(gaprole_States_t newState) {
  * @return  None.
  */
 static void ETX_charValueChangeCB(uint8_t paramID) {
-	ETX_enqueueMsg(ETX_CHAR_CHANGE_EVT, paramID);
+	ETX_enqueueMsg(ETX_CHAR_CHANGE_EVT, paramID, NULL);
 }
 
 /*********************************************************************
@@ -1002,17 +1211,36 @@ static void ETX_processCharValueChangeEvt(uint8_t paramID) {
 			break;
 
 		case EVRSPROFILE_CMD:
-			EVRSProfile_GetParameter(EVRSPROFILE_CMD, &newValue);
+		{
+			uint8_t cmd[EVRSPROFILE_CMD_LEN];
 
-			uout1("BS Command: 0x%02x",
-					(uint8_t )newValue);
+			EVRSProfile_GetParameter(EVRSPROFILE_CMD, cmd);
+
+			uout2("BS Command: 0x%02x 0x%02x", cmd[0], cmd[1]);
+			ETX_applyCmd(cmd[0], cmd[1]);
+		}
 			break;
 
 		case EVRSPROFILE_DATA:
-			EVRSProfile_GetParameter(EVRSPROFILE_DATA, &newValue);
-
-			uout1("User Data: 0x%02x",
-					(uint8_t )newValue);
+		{
+			uint8_t ack[EVRSPROFILE_ACK_LEN];
+			uint8_t i;
+
+			// The acknowledgement frees the journal up to its vote and
+			// carries the base station commands, all applied from the
+			// one write
+			EVRSProfile_GetParameter(EVRSPROFILE_ACK, ack);
+			uout1("Vote %d acked", BUILD_UINT16(ack[1], ack[2]));
+			ETX_Journal_reclaim(BUILD_UINT16(ack[1], ack[2]));
+
+			for (i = EVRSPROFILE_ACK_HDR_LEN;
+					i < EVRSPROFILE_ACK_LEN && ack[i] != ETX_CMD_OP_NONE;
+					i += EVRSPROFILE_CMD_LEN)
+			{
+				uout2("BS Command: 0x%02x 0x%02x", ack[i], ack[i + 1]);
+				ETX_applyCmd(ack[i], ack[i + 1]);
+			}
+		}
 			break;
 
 		default:
@@ -1028,23 +1256,250 @@ static void ETX_processCharValueChangeEvt(uint8_t paramID) {
  *
  * @param   event - message event.
  * @param   state - message state.
+ * @param   pData - ICall_malloc'd message data, freed with the message,
+ *                  also when it cannot be queued. NULL for none.
  *
- * @return  None.
+ * @return  TRUE if queued
  */
-static void ETX_enqueueMsg(uint8_t event, uint8_t state) {
+static bool ETX_enqueueMsg(uint8_t event, uint8_t state, uint8_t *pData) {
 	sbpEvt_t *pMsg;
 
 	// Create dynamic pointer to message.
 	if ((pMsg = ICall_malloc(sizeof(sbpEvt_t))))
 	{
+		etxLane_t lane = (event == ETX_KEY_CHANGE_EVT) ?
+				ETX_LANE_LOW : ETX_LANE_HIGH;
+
 		pMsg->hdr.event = event;
 		pMsg->hdr.state = state;
+		pMsg->pData = pData;
 
 		// Enqueue the message.
-		Util_enqueueMsg(appMsgQueue, sem, (uint8*) pMsg);
+		if (Board_MsgQ_enqueue(&appLanes[lane], sem, (uint8*) pMsg))
+		{
+			return TRUE;
+		}
+		ICall_free(pMsg);
+	}
+
+	if (pData != NULL)
+	{
+		ICall_free(pData);
 	}
+	return FALSE;
 }
 
+/*********************************************************************
+ * @fn      ETX_applyCmd
+ *
+ * @brief   Carry out a base station command, written to CMD or heard
+ *          in a broadcast. Unknown opcodes are ignored.
+ *
+ * @param   op - ETX_CMD_OP_*
+ * @param   arg - command argument
+ *
+ * @return  None.
+ */
+static void ETX_applyCmd(uint8_t op, uint8_t arg) {
+	if (op == ETX_CMD_OP_TXPWR
+			&& (int8_t) arg != txPower
+			&& ETX_TxPower_Set((int8_t) arg))
+	{
+		// Advertise and keep the new power
+		GAPRole_SetParameter(GAPROLE_SCAN_RSP_DATA,
+				sizeof(scanRspData), scanRspData);
+		osal_snv_write(ETX_TXPWR_NV_ID, sizeof(txPower),
+				(uint8 *) &txPower);
+	}
+
+	if (op == ETX_CMD_OP_EPOCH && arg != voteEpoch)
+	{
+		// New question, later votes are cast in it
+		voteEpoch = arg;
+		osal_snv_write(ETX_EPOCH_NV_ID, sizeof(voteEpoch),
+				(uint8 *) &voteEpoch);
+		uout1("Epoch %d", voteEpoch);
+	}
+}
+
+/*********************************************************************
+ * @fn      ETX_Batt_read
+ *
+ * @brief   Read the battery voltage.
+ *
+ * @return  battery voltage in mV
+ */
+static uint16_t ETX_Batt_read(void) {
+	// 3.8 fixed point volts
+	return (uint16_t) ((AONBatMonBatteryVoltageGet() * 1000) >> 8);
+}
+
+/*********************************************************************
+ * @fn      ETX_Journal_add
+ *
+ * @brief   Keep a vote record the base station has not acknowledged.
+ *          With the journal full the oldest record is dropped.
+ *
+ * @param   pRec - vote record, EVRSPROFILE_DATA_LEN bytes
+ *
+ * @return  none
+ */
+static void ETX_Journal_add(const uint8_t *pRec) {
+	if (journalCount == EVRSPROFILE_JOURNAL_MAX)
+	{
+		journalHead = (journalHead + 1) % EVRSPROFILE_JOURNAL_MAX;
+		journalCount--;
+		journalDrops++;
+		ulog1(WARN, "Journal full, %d dropped", journalDrops);
+	}
+
+	memcpy(journal[(journalHead + journalCount) % EVRSPROFILE_JOURNAL_MAX],
+			pRec, EVRSPROFILE_DATA_LEN);
+	journalCount++;
+}
+
+/*********************************************************************
+ * @fn      ETX_Journal_reclaim
+ *
+ * @brief   Free the records up to and including an acknowledged vote
+ *          and publish what is left.
+ *
+ * @param   ackSeq - sequence number the base station acknowledged
+ *
+ * @return  none
+ */
+static void ETX_Journal_reclaim(uint16_t ackSeq) {
+	uint8_t data[EVRSPROFILE_DATA_LEN];
+
+	while (journalCount > 0)
+	{
+		uint8_t *pRec = journal[journalHead];
+
+		if ((int16_t) (BUILD_UINT16(pRec[EVRSPROFILE_DATA_SEQ_IDX],
+				pRec[EVRSPROFILE_DATA_SEQ_IDX + 1]) - ackSeq) > 0)
+		{
+			break;
+		}
+		journalHead = (journalHead + 1) % EVRSPROFILE_JOURNAL_MAX;
+		journalCount--;
+	}
+
+	EVRSProfile_GetParameter(EVRSPROFILE_DATA, data);
+	if ((int16_t) (BUILD_UINT16(data[EVRSPROFILE_DATA_SEQ_IDX],
+			data[EVRSPROFILE_DATA_SEQ_IDX + 1]) - ackSeq) <= 0)
+	{
+		voteAcked = TRUE;
+	}
+
+	ETX_Journal_publish(data);
+}
+
+/*********************************************************************
+ * @fn      ETX_Journal_publish
+ *
+ * @brief   Set the data characteristic to the last vote followed by the
+ *          journal, oldest first.
+ *
+ * @param   pRec - last vote record, EVRSPROFILE_DATA_LEN bytes
+ *
+ * @return  none
+ */
+static void ETX_Journal_publish(const uint8_t *pRec) {
+	uint8_t buf[EVRSPROFILE_DATA_MAX_LEN];
+	uint8_t len = EVRSPROFILE_DATA_LEN;
+	uint8_t i;
+
+	memcpy(buf, pRec, EVRSPROFILE_DATA_LEN);
+	buf[len++] = journalCount;
+	for (i = 0; i < journalCount; i++)
+	{
+		memcpy(&buf[len],
+				journal[(journalHead + i) % EVRSPROFILE_JOURNAL_MAX],
+				EVRSPROFILE_DATA_LEN);
+		len += EVRSPROFILE_DATA_LEN;
+	}
+
+	EVRSProfile_SetParameter(EVRSPROFILE_DATA, len, buf);
+}
+
+#ifdef PLUS_OBSERVER
+/*********************************************************************
+ * @fn      ETX_observe
+ *
+ * @brief   Observe timer handler, open a short passive scan for command
+ *          broadcasts. Skipped while connected, the base station writes
+ *          CMD then, and before a base station is chosen.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  None.
+ */
+static void ETX_observe(UArg a0) {
+	if (destBsID == 0x00 || linkDB_NumActive() > 0)
+	{
+		return;
+	}
+
+	GAP_SetParamValue(TGAP_GEN_DISC_SCAN, ETX_OBSERVE_WINDOW);
+	GAP_SetParamValue(TGAP_GEN_DISC_SCAN_INT, ETX_OBSERVE_WINDOW * 8 / 5);
+	GAP_SetParamValue(TGAP_GEN_DISC_SCAN_WIND, ETX_OBSERVE_WINDOW * 8 / 5);
+
+	// Fails harmlessly if the last window is still open
+	GAPRole_StartDiscovery(DEVDISC_MODE_ALL, FALSE, FALSE);
+}
+
+/*********************************************************************
+ * @fn      ETX_observerCB
+ *
+ * @brief   Observer role callback, runs in the GAP role task. Adverts
+ *          are checked in place, only a new broadcast of our base
+ *          station is copied and queued.
+ *
+ * @param   pEvent - observer event
+ *
+ * @return  None.
+ */
+static void ETX_observerCB(gapPeripheralObserverRoleEvent_t *pEvent) {
+	uint8_t *pAd = pEvent->deviceInfo.pEvtData;
+	uint8_t *pEnd = pAd + pEvent->deviceInfo.dataLen;
+
+	if (pEvent->gap.opcode != GAP_DEVICE_INFO_EVENT)
+	{
+		return;
+	}
+
+	// Walk the AD structures, [len, type, value]
+	while (pAd + 1 < pEnd && pAd[0] != 0 && pAd + 1 + pAd[0] <= pEnd)
+	{
+		uint8_t *pVal = &pAd[2];
+
+		if (pAd[1] == ETX_ADTYPE_BCAST && pAd[0] > ETX_BCAST_LEN
+				&& pVal[ETX_BCAST_BSID_IDX] == destBsID
+				&& (!bcastHeard || memcmp(bcastLast, &pVal[ETX_BCAST_SEQ_IDX],
+						sizeof(bcastLast)) != 0))
+		{
+			// [epoch, op, arg]
+			uint8_t *pCmd = ICall_malloc(ETX_BCAST_LEN - ETX_BCAST_EPOCH_IDX);
+
+			if (pCmd != NULL)
+			{
+				memcpy(pCmd, &pVal[ETX_BCAST_EPOCH_IDX],
+						ETX_BCAST_LEN - ETX_BCAST_EPOCH_IDX);
+				if (ETX_enqueueMsg(ETX_BCAST_EVT, 0, pCmd))
+				{
+					memcpy(bcastLast, &pVal[ETX_BCAST_SEQ_IDX],
+							sizeof(bcastLast));
+					bcastHeard = TRUE;
+				}
+			}
+			return;
+		}
+
+		pAd += pAd[0] + 1;
+	}
+}
+#endif // PLUS_OBSERVER
+
 /*********************************************************************
  * @fn      ETX_keyChangeHandler
  *
@@ -1055,7 +1510,19 @@ static void ETX_enqueueMsg(uint8_t event, uint8_t state) {
  * @return  none
  */
 void ETX_keyChangeHandler(uint8_t keys) {
-	ETX_enqueueMsg(ETX_KEY_CHANGE_EVT, keys);
+	ETX_enqueueMsg(ETX_KEY_CHANGE_EVT, keys, NULL);
+}
+
+/*********************************************************************
+ * @fn      ETX_timerWakeHandler
+ *
+ * @brief   App timer wheel clock handler, wakes the app task to fire
+ *          the due timers.
+ *
+ * @return  none
+ */
+static void ETX_timerWakeHandler(void) {
+	Semaphore_post(sem);
 }
 
 /*********************************************************************
@@ -1073,6 +1540,14 @@ void ETX_keyChangeHandler(uint8_t keys) {
 static void ETX_handleKeys(uint8_t shift, uint8_t keys) {
 	//uout0("handleKey() called");
 	uint8_t advertEnable = FALSE;
+
+	// Both keys at once request a telemetry report in any state
+	if ((keys & (KEY_LEFT | KEY_RIGHT)) == (KEY_LEFT | KEY_RIGHT))
+	{
+		ETX_reportTelemetry(0);
+		return;
+	}
+
 	switch (appState)
 	{
 		case APP_STATE_INIT:
@@ -1100,10 +1575,47 @@ static void ETX_handleKeys(uint8_t shift, uint8_t keys) {
 			}
 			if (keys & KEY_RIGHT)
 			{
-				uint32 newValue = 0;
-				EVRSProfile_GetParameter(EVRSPROFILE_DATA, &newValue);
-				newValue += 1;
-				EVRSProfile_SetParameter(EVRSPROFILE_DATA, sizeof(uint32), &newValue );
+				uint8_t data[EVRSPROFILE_DATA_LEN];
+				uint32_t castMs = (uint32_t) ((uint64_t) Clock_getTicks()
+						* Clock_tickPeriod / 1000);
+				uint16_t battMv = ETX_Batt_read();
+				uint8_t option;
+
+				// Next vote value under a new sequence number, kept in NV
+				// first so a reset cannot hand the number out twice
+				EVRSProfile_GetParameter(EVRSPROFILE_DATA, data);
+				if (!voteAcked)
+				{
+					// Replaced before the base station took it
+					ETX_Journal_add(data);
+				}
+				// Next option, the first after the last or after no vote
+				option = data[EVRSPROFILE_DATA_VOTE_IDX] - EVRSPROFILE_VOTE_FIRST;
+				option = (option < EVRSPROFILE_VOTE_NUM_OPTIONS - 1) ?
+						option + 1 : 0;
+				data[EVRSPROFILE_DATA_VOTE_IDX] = EVRSPROFILE_VOTE_FIRST + option;
+				voteSeq++;
+				osal_snv_write(ETX_VOTESEQ_NV_ID, sizeof(voteSeq),
+						(uint8 *) &voteSeq);
+				data[EVRSPROFILE_DATA_SEQ_IDX] = LO_UINT16(voteSeq);
+				data[EVRSPROFILE_DATA_SEQ_IDX + 1] = HI_UINT16(voteSeq);
+				data[EVRSPROFILE_DATA_EPOCH_IDX] = voteEpoch;
+				data[EVRSPROFILE_DATA_VER_IDX] = EVRSPROFILE_DATA_VER;
+				data[EVRSPROFILE_DATA_TIME_IDX] = BREAK_UINT32(castMs, 0);
+				data[EVRSPROFILE_DATA_TIME_IDX + 1] = BREAK_UINT32(castMs, 1);
+				data[EVRSPROFILE_DATA_TIME_IDX + 2] = BREAK_UINT32(castMs, 2);
+				data[EVRSPROFILE_DATA_TIME_IDX + 3] = BREAK_UINT32(castMs, 3);
+				data[EVRSPROFILE_DATA_BATT_IDX] = LO_UINT16(battMv);
+				data[EVRSPROFILE_DATA_BATT_IDX + 1] = HI_UINT16(battMv);
+				voteAcked = FALSE;
+				ETX_Journal_publish(data);
+
+				// Tell the base station there is new data
+				ETX_Advert_UpdateDataVer();
+				GAPRole_SetParameter(GAPROLE_ADVERT_DATA, sizeof(advertData),
+						advertData);
+				uout3("Data ver 0x%02x seq %d journal %d", dataVer, voteSeq,
+						journalCount);
 				appState = APP_STATE_IDLE;
 			}
 			break;
@@ -1113,6 +1625,42 @@ static void ETX_handleKeys(uint8_t shift, uint8_t keys) {
 	}
 }
 
+/*********************************************************************
+ * @fn      ETX_reportTelemetry
+ *
+ * @brief   Telemetry timer handler, also run on request. Prints the app
+ *          and idle task stacks, the ICall heap and the app lanes.
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void ETX_reportTelemetry(UArg a0) {
+	boardTaskMem_t taskMem;
+	boardHeapMem_t heapMem;
+	uint8_t lane;
+
+	Board_Telemetry_task(Task_handle(&sbpTask), &taskMem);
+	uout2("Stack app %d/%d", taskMem.stackPeak, taskMem.stackSize);
+	Board_Telemetry_task(Task_getIdleTask(), &taskMem);
+	uout2("Stack idle %d/%d", taskMem.stackPeak, taskMem.stackSize);
+
+	if (Board_Telemetry_heap(&heapMem))
+	{
+		uout3("Heap %d peak %d ub %d", heapMem.allocated, heapMem.peak,
+				heapMem.upperBound);
+		uout2("Heap blocks %d free %d", heapMem.blocks, heapMem.freeBlocks);
+	}
+
+	for (lane = 0; lane < ETX_NUM_LANES; lane++)
+	{
+		boardMsgLaneStats_t stats;
+
+		Board_MsgQ_getStats(&appLanes[lane], &stats);
+		uout3("Lane %d depth %d hw %d", lane, stats.depth, stats.highWater);
+	}
+}
+
 static void ETX_DevId_Find(uint8_t* nvBuf) {
 	uint8_t rtn = osal_snv_read(ETX_DEVID_NV_ID, ETX_DEVID_LEN, (uint8 *)nvBuf);
 	if (rtn == SUCCESS)
@@ -1151,5 +1699,37 @@ static void ETX_Advert_UpdateDestinyBS() {
 	advertData[9] = destBsID;
 }
 
+static void ETX_Advert_UpdateDataVer() {
+	dataVer++;
+	advertData[12] = dataVer;
+}
+
+/*********************************************************************
+ * @fn      ETX_TxPower_Set
+ *
+ * @brief   Apply an output power and put it in the scan response.
+ *
+ * @param   dbm - output power in dBm, one of txPowerLevels
+ *
+ * @return  TRUE if the power is supported and applied
+ */
+static bool ETX_TxPower_Set(int8_t dbm) {
+	uint8_t level;
+
+	for (level = 0; level < sizeof(txPowerLevels); level++)
+	{
+		if (txPowerLevels[level] == dbm)
+		{
+			HCI_EXT_SetTxPowerCmd(level);
+			txPower = dbm;
+			scanRspData[ETX_SCANRSP_TXPWR_IDX] = (uint8_t) dbm;
+			uout1("Tx power %d dBm", dbm);
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
 /*********************************************************************
  *********************************************************************/
@@ -48,6 +48,9 @@
  * INCLUDES
  */
 
+// Log site file ID, see board_log.h
+#define BOARD_LOG_FILE_ID 2
+
 #include <xdc/runtime/Error.h>
 
 #include <ti/drivers/Power.h>
@@ -71,7 +74,7 @@ bleUserCfg_t user0Cfg = BLE_USER_CFG;
 
 #endif // USE_DEFAULT_USER_CFG
 
-#include <ti/mw/display/Display.h>
+#include "board_display.h"
 
 /*******************************************************************************
  * MACROS
@@ -99,8 +102,6 @@ bleUserCfg_t user0Cfg = BLE_USER_CFG;
 
 extern void AssertHandler(uint8 assertCause, uint8 assertSubcause);
 
-extern Display_Handle dispHandle;
-
 /*******************************************************************************
  * @fn          Main
  *
@@ -192,48 +193,47 @@ int main()
  */
 void AssertHandler(uint8 assertCause, uint8 assertSubcause)
 {
-  // Open the display if the app has not already done so
-  if ( !dispHandle )
-  {
-    dispHandle = Display_open(Display_Type_LCD, NULL);
-  }
-
-  Display_print0(dispHandle, 0, 0, ">>>STACK ASSERT");
+  // The UART display prints nothing until the app has opened it
+  ulog0(ERR, ">>>STACK ASSERT");
 
   // check the assert cause
   switch (assertCause)
   {
     case HAL_ASSERT_CAUSE_OUT_OF_MEMORY:
-      Display_print0(dispHandle, 0, 0, "***ERROR***");
-      Display_print0(dispHandle, 2, 0, ">> OUT OF MEMORY!");
+      ulog0(ERR, "***ERROR***");
+      ulog0(ERR, ">> OUT OF MEMORY!");
       break;
 
     case HAL_ASSERT_CAUSE_INTERNAL_ERROR:
       // check the subcause
       if (assertSubcause == HAL_ASSERT_SUBCAUSE_FW_INERNAL_ERROR)
       {
-        Display_print0(dispHandle, 0, 0, "***ERROR***");
-        Display_print0(dispHandle, 2, 0, ">> INTERNAL FW ERROR!");
+        ulog0(ERR, "***ERROR***");
+        ulog0(ERR, ">> INTERNAL FW ERROR!");
       }
       else
       {
-        Display_print0(dispHandle, 0, 0, "***ERROR***");
-        Display_print0(dispHandle, 2, 0, ">> INTERNAL ERROR!");
+        ulog0(ERR, "***ERROR***");
+        ulog0(ERR, ">> INTERNAL ERROR!");
       }
       break;
 
     case HAL_ASSERT_CAUSE_ICALL_ABORT:
-      Display_print0(dispHandle, 0, 0, "***ERROR***");
-      Display_print0(dispHandle, 2, 0, ">> ICALL ABORT!");
+      ulog0(ERR, "***ERROR***");
+      ulog0(ERR, ">> ICALL ABORT!");
+      Board_Log_flush();
       HAL_ASSERT_SPINLOCK;
       break;
 
     default:
-      Display_print0(dispHandle, 0, 0, "***ERROR***");
-      Display_print0(dispHandle, 2, 0, ">> DEFAULT SPINLOCK!");
+      ulog0(ERR, "***ERROR***");
+      ulog0(ERR, ">> DEFAULT SPINLOCK!");
+      Board_Log_flush();
       HAL_ASSERT_SPINLOCK;
   }
 
+  Board_Log_flush();
+
   return;
 }
 
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""Decode the tokenized log of the EVRS BS and Tx apps.
+
+The target sends each log site as its ID, a timestamp and its raw
+arguments (see drv/board_log.c). The format strings are taken from the
+app sources, either directly or from a table made at build time:
+
+    evrs_logdecode.py table evrs_bs_cc2650lp_app -o bs_log.json
+    evrs_logdecode.py decode -t bs_log.json /dev/ttyACM0
+    evrs_logdecode.py decode -s evrs_bs_cc2650lp_app capture.bin
+
+The serial port must already be set to 115200 8N1 raw, e.g.
+stty -F /dev/ttyACM0 115200 raw -echo. Frames other than log records
+are printed in hex, bytes outside frames are printed as text so a
+BOARD_DISPLAY_TEXT build can be read with the same tool.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+FRAME_SOF = 0xA5
+LOG_FRAME = 0x01
+
+FILE_ID_RE = re.compile(r'^\s*#define\s+BOARD_LOG_FILE_ID\s+(\d+)', re.M)
+SITE_RE = re.compile(r'\b(uout|ulog)(\d)\s*\(')
+LEVEL_RE = re.compile(r'\s*\w+\s*,')
+STRING_RE = re.compile(r'\s*"((?:[^"\\]|\\.)*)"')
+SPEC_RE = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?[hlLzjt]*([diouxXcsp%])')
+
+
+def c_unescape(text):
+    return bytes(text, 'utf-8').decode('unicode_escape')
+
+
+def scan_file(path, table):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        src = f.read()
+
+    m = FILE_ID_RE.search(src)
+    if m is None:
+        return
+    file_id = int(m.group(1))
+
+    for site in SITE_RE.finditer(src):
+        line_start = src.rfind('\n', 0, site.start()) + 1
+        if '//' in src[line_start:site.start()]:
+            continue
+
+        # Leveled sites take the level first
+        pos = site.end()
+        if site.group(1) == 'ulog':
+            level = LEVEL_RE.match(src, pos)
+            if level is None:
+                continue
+            pos = level.end()
+        start = pos
+
+        # Adjacent literals are joined like the compiler does
+        fmt = ''
+        while True:
+            lit = STRING_RE.match(src, pos)
+            if lit is None:
+                break
+            fmt += c_unescape(lit.group(1))
+            pos = lit.end()
+        if pos == start:
+            continue
+
+        # __LINE__ may be the line of the name or of the closing paren
+        depth = 1
+        end = pos
+        while end < len(src) and depth:
+            if src[end] == '(':
+                depth += 1
+            elif src[end] == ')':
+                depth -= 1
+            end += 1
+
+        first = src.count('\n', 0, site.start()) + 1
+        last = src.count('\n', 0, end) + 1
+        entry = {'fmt': fmt, 'nargs': int(site.group(2)),
+                 'where': '%s:%d' % (os.path.basename(path), first)}
+        for line in range(first, last + 1):
+            key = str((file_id << 12) | (line & 0x0FFF))
+            old = table.get(key)
+            if old is not None and old['where'] != entry['where']:
+                sys.stderr.write('ID %s used by %s and %s\n'
+                                 % (key, old['where'], entry['where']))
+            table.setdefault(key, entry)
+
+
+def build_table(paths):
+    table = {}
+    for top in paths:
+        for root, _, files in os.walk(top):
+            if os.path.basename(root) in ('Debug', 'FlashROM'):
+                continue
+            for name in sorted(files):
+                if name.endswith('.c'):
+                    scan_file(os.path.join(root, name), table)
+    return table
+
+
+def format_c(fmt, args):
+    args = list(args)
+
+    def conv(m):
+        flags, width, prec, kind = m.groups()
+        if kind == '%':
+            return '%'
+        value = args.pop(0) if args else 0
+        if kind in 'di':
+            value = struct.unpack('<i', struct.pack('<I', value & 0xFFFFFFFF))[0]
+        elif kind == 'c':
+            return chr(value & 0xFF)
+        elif kind in 's':
+            return '<%#x>' % value
+        else:
+            value &= 0xFFFFFFFF
+            if kind == 'p':
+                kind = 'x'
+        spec = '%' + flags + width + ('.' + prec if prec else '') + kind
+        return spec % value
+
+    return SPEC_RE.sub(conv, fmt)
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def decode_log(payload, table, out):
+    if len(payload) < 4:
+        return
+    stamp = struct.unpack_from('<I', payload)[0]
+    pos = 4
+    try:
+        while pos < len(payload):
+            site, = struct.unpack_from('<H', payload, pos)
+            dt, pos = read_varint(payload, pos + 2)
+            stamp += dt
+            entry = table.get(str(site))
+            if entry is None:
+                # Argument count unknown, the rest of the frame is lost
+                out.write('%10.3f  <unknown site 0x%04x>\n'
+                          % (stamp / 1000.0, site))
+                return
+            args = []
+            for _ in range(entry['nargs']):
+                raw, pos = read_varint(payload, pos)
+                args.append((raw >> 1) ^ -(raw & 1))
+            out.write('%10.3f  %s\n' % (stamp / 1000.0,
+                                       format_c(entry['fmt'], args)))
+    except (IndexError, struct.error):
+        out.write('%10.3f  <truncated record>\n' % (stamp / 1000.0))
+
+
+def decode_stream(stream, table, out):
+    state = 'sof'
+    frame_type = length = check = 0
+    payload = bytearray()
+    text = bytearray()
+
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        byte = chunk[0]
+
+        if state == 'sof':
+            if byte == FRAME_SOF:
+                state = 'type'
+            elif byte in (0x0A, 0x0D):
+                if text:
+                    out.write(text.decode('ascii', 'replace').lstrip('\f')
+                              + '\n')
+                    text = bytearray()
+            else:
+                text.append(byte)
+        elif state == 'type':
+            frame_type = check = byte
+            state = 'len'
+        elif state == 'len':
+            length = byte
+            check ^= byte
+            payload = bytearray()
+            state = 'data' if length else 'check'
+        elif state == 'data':
+            payload.append(byte)
+            check ^= byte
+            if len(payload) == length:
+                state = 'check'
+        else:
+            state = 'sof'
+            if byte != check:
+                out.write('<bad checksum, frame 0x%02x dropped>\n'
+                          % frame_type)
+            elif frame_type == LOG_FRAME:
+                decode_log(bytes(payload), table, out)
+            else:
+                out.write('frame 0x%02x: %s\n'
+                          % (frame_type, payload.hex()))
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('table', help='make the site table from app sources')
+    p.add_argument('src', nargs='+', help='app source directories')
+    p.add_argument('-o', '--output', default='-', help='table file')
+
+    p = sub.add_parser('decode', help='decode a port or capture')
+    group = p.add_mutually_exclusive_group(required=True)
+    group.add_argument('-t', '--table', help='table file')
+    group.add_argument('-s', '--src', action='append',
+                       help='app source directory, may be repeated')
+    p.add_argument('input', nargs='?', default='-',
+                   help='serial device or capture file')
+
+    args = parser.parse_args()
+
+    if args.cmd == 'table':
+        table = build_table(args.src)
+        text = json.dumps(table, indent=1, sort_keys=True)
+        if args.output == '-':
+            print(text)
+        else:
+            with open(args.output, 'w') as f:
+                f.write(text + '\n')
+        return
+
+    if args.table:
+        with open(args.table) as f:
+            table = json.load(f)
+    else:
+        table = build_table(args.src)
+
+    if args.input == '-':
+        decode_stream(sys.stdin.buffer, table, sys.stdout)
+    else:
+        with open(args.input, 'rb', buffering=0) as stream:
+            decode_stream(stream, table, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,89 @@
+/*
+ * Host stand-in for the TI-RTOS Clock module and Util_constructClock,
+ * see stubs/ti/sysbios/knl/Clock.h.
+ */
+
+#include <stddef.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include "Util.h"
+
+uint32_t Clock_tickPeriod = 10;
+
+static uint32_t hostTicks = 0;
+static Clock_Struct *pClocks = NULL;
+
+uint32_t Clock_getTicks(void) {
+	return hostTicks;
+}
+
+Clock_Handle Clock_handle(Clock_Struct *pClock) {
+	return pClock;
+}
+
+void Clock_start(Clock_Handle handle) {
+	handle->due = hostTicks + handle->timeout;
+	handle->active = true;
+}
+
+void Clock_stop(Clock_Handle handle) {
+	handle->active = false;
+}
+
+void Clock_setTimeout(Clock_Handle handle, uint32_t timeout) {
+	handle->timeout = timeout;
+}
+
+Clock_Handle Util_constructClock(Clock_Struct *pClock,
+		Clock_FuncPtr clockCB, uint32_t clockDuration,
+		uint32_t clockPeriod, uint8_t startFlag, UArg arg) {
+	pClock->fxn = clockCB;
+	pClock->arg = arg;
+	pClock->timeout = clockDuration * 1000 / Clock_tickPeriod;
+	pClock->period = clockPeriod * 1000 / Clock_tickPeriod;
+	pClock->active = false;
+
+	// Constructed again on a re-init, link it once
+	{
+		Clock_Struct *p;
+
+		for (p = pClocks; p != NULL && p != pClock; p = p->pNext)
+			;
+		if (p == NULL)
+		{
+			pClock->pNext = pClocks;
+			pClocks = pClock;
+		}
+	}
+
+	if (startFlag)
+	{
+		Clock_start(pClock);
+	}
+
+	return pClock;
+}
+
+void HostClock_set(uint32_t ticks) {
+	hostTicks = ticks;
+}
+
+// Fire the clocks due by now, as the clock SWI would
+void HostClock_run(void) {
+	Clock_Struct *pClock;
+
+	for (pClock = pClocks; pClock != NULL; pClock = pClock->pNext)
+	{
+		if (pClock->active && (int32_t) (hostTicks - pClock->due) >= 0)
+		{
+			if (pClock->period)
+			{
+				pClock->due += pClock->period;
+			} else
+			{
+				pClock->active = false;
+			}
+			pClock->fxn(pClock->arg);
+		}
+	}
+}
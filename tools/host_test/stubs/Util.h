@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for the TI Util.h, the clock helper only. The Makefile
+ * also copies it as util.h, the name board_timer.c includes.
+ */
+
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <stdint.h>
+#include <ti/sysbios/knl/Clock.h>
+
+Clock_Handle Util_constructClock(Clock_Struct *pClock,
+		Clock_FuncPtr clockCB, uint32_t clockDuration,
+		uint32_t clockPeriod, uint8_t startFlag, UArg arg);
+
+#endif /* UTIL_H */
@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for the BLE stack bcomdef.h, only what the modules
+ * built by tools/host_test use.
+ */
+
+#ifndef BCOMDEF_H
+#define BCOMDEF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+#define LO_UINT16(a)			((a) & 0xFF)
+#define HI_UINT16(a)			(((a) >> 8) & 0xFF)
+#define BUILD_UINT16(l, h)		((uint16)(((l) & 0xFF) | (((h) & 0xFF) << 8)))
+#define BUILD_UINT32(a, b, c, d)	((uint32)((uint32)((a) & 0xFF) \
+		| ((uint32)((b) & 0xFF) << 8) | ((uint32)((c) & 0xFF) << 16) \
+		| ((uint32)((d) & 0xFF) << 24)))
+#define BREAK_UINT32(v, b)		((uint8)(((v) >> ((b) * 8)) & 0xFF))
+
+#endif /* BCOMDEF_H */
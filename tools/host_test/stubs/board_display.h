@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for drv/board_display.h, the framed uplink only. The
+ * harness linking evrs_bs_uplink.c provides the functions.
+ */
+
+#ifndef BOARD_DISPLAY_H
+#define BOARD_DISPLAY_H
+
+#include <stdint.h>
+
+#define BOARD_DISPLAY_FRAME_SOF		0xA5
+#define BOARD_DISPLAY_FRAME_MAX		250
+
+#ifndef BOARD_DISPLAY_TX_RING
+#define BOARD_DISPLAY_TX_RING		512
+#endif
+
+void Board_Display_Frame(uint8_t type, const uint8_t *pData, uint8_t len);
+uint16_t Board_Display_TxFree(void);
+
+#endif /* BOARD_DISPLAY_H */
@@ -0,0 +1,40 @@
+/*
+ * Host stand-in for the TI-RTOS Clock module. One tick counter the test
+ * moves with HostClock_set, clocks fire from HostClock_run.
+ */
+
+#ifndef ti_sysbios_knl_Clock__include
+#define ti_sysbios_knl_Clock__include
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uintptr_t UArg;
+typedef void (*Clock_FuncPtr)(UArg arg);
+
+typedef struct Clock_Struct {
+	struct Clock_Struct *pNext;	// next constructed clock
+	Clock_FuncPtr fxn;
+	UArg arg;
+	uint32_t timeout;			// ticks from start
+	uint32_t period;			// reload in ticks, 0 for one-shot
+	uint32_t due;				// tick to fire at
+	bool active;
+} Clock_Struct;
+
+typedef Clock_Struct *Clock_Handle;
+
+// RTOS tick in us, the CC2650 default
+extern uint32_t Clock_tickPeriod;
+
+uint32_t Clock_getTicks(void);
+Clock_Handle Clock_handle(Clock_Struct *pClock);
+void Clock_start(Clock_Handle handle);
+void Clock_stop(Clock_Handle handle);
+void Clock_setTimeout(Clock_Handle handle, uint32_t timeout);
+
+// Host side control
+void HostClock_set(uint32_t ticks);
+void HostClock_run(void);
+
+#endif /* ti_sysbios_knl_Clock__include */
@@ -0,0 +1,100 @@
+/*
+ * Host test of the vote tally, src/evrs_bs_tally.c built for Linux. Feeds
+ * it the vote values a Tx really sends, ETX_VOTE_FIRST onwards, and
+ * checks the per option counts, re-votes, out of range values and the
+ * packed snapshot.
+ *
+ *     make -C tools/host_test tally
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "evrs_bs_tally.h"
+
+static unsigned errors = 0;
+
+#define CHECK(cond)	do { \
+		if (!(cond)) { \
+			printf("FAIL line %d: %s\n", __LINE__, #cond); \
+			errors++; \
+		} \
+	} while (0)
+
+// Count of option n in a packed snapshot, 0 past the options packed
+static uint16_t packedCount(const uint8_t *pBuf, uint8_t n) {
+	if (n >= pBuf[7])
+	{
+		return 0;
+	}
+	return BUILD_UINT16(pBuf[8 + 2 * n], pBuf[9 + 2 * n]);
+}
+
+int main(void) {
+	uint8_t buf[EBS_TALLY_PACKED_MAX];
+	uint8_t len;
+	uint16_t rev;
+
+	EBS_Tally_reset(3);
+
+	// A Tx pressed once sends the first option
+	CHECK(EBS_Tally_vote(0, ETX_VOTE_FIRST));
+	CHECK(EBS_Tally_vote(1, ETX_VOTE_FIRST + 2));
+	CHECK(EBS_Tally_vote(2, ETX_VOTE_FIRST + 2));
+	CHECK(EBS_Tally_vote(3, ETX_VOTE_FIRST + ETX_VOTE_NUM_OPTIONS - 1));
+
+	len = EBS_Tally_pack(buf);
+	CHECK(buf[2] == 3);
+	CHECK(BUILD_UINT16(buf[3], buf[4]) == 4);		// voters
+	CHECK(BUILD_UINT16(buf[5], buf[6]) == 0);		// invalid
+	CHECK(buf[7] == ETX_VOTE_NUM_OPTIONS);
+	CHECK(len == 8 + 2 * ETX_VOTE_NUM_OPTIONS);
+	CHECK(packedCount(buf, 0) == 1);
+	CHECK(packedCount(buf, 1) == 0);
+	CHECK(packedCount(buf, 2) == 2);
+	CHECK(packedCount(buf, ETX_VOTE_NUM_OPTIONS - 1) == 1);
+
+	// Same vote again changes nothing, a re-vote moves the count
+	rev = EBS_Tally_revision();
+	CHECK(!EBS_Tally_vote(1, ETX_VOTE_FIRST + 2));
+	CHECK(EBS_Tally_revision() == rev);
+	CHECK(EBS_Tally_vote(1, ETX_VOTE_FIRST + 1));
+	CHECK(EBS_Tally_revision() != rev);
+	EBS_Tally_vote(3, ETX_VOTE_FIRST);
+	len = EBS_Tally_pack(buf);
+	CHECK(BUILD_UINT16(buf[3], buf[4]) == 4);
+	CHECK(buf[7] == 3);
+	CHECK(len == 8 + 2 * 3);
+	CHECK(packedCount(buf, 0) == 2);
+	CHECK(packedCount(buf, 1) == 1);
+	CHECK(packedCount(buf, 2) == 1);
+
+	// Values outside the options are invalid, raw option indexes too
+	CHECK(EBS_Tally_vote(4, ETX_VOTE_FIRST + ETX_VOTE_NUM_OPTIONS));
+	CHECK(EBS_Tally_vote(5, 0));
+	CHECK(EBS_Tally_vote(6, ETX_VOTE_FIRST - 1));
+	EBS_Tally_pack(buf);
+	CHECK(BUILD_UINT16(buf[3], buf[4]) == 7);
+	CHECK(BUILD_UINT16(buf[5], buf[6]) == 3);
+	CHECK(packedCount(buf, 0) == 2);
+
+	// An invalid vote replaced by a valid one
+	CHECK(EBS_Tally_vote(5, ETX_VOTE_FIRST + 1));
+	EBS_Tally_pack(buf);
+	CHECK(BUILD_UINT16(buf[5], buf[6]) == 2);
+	CHECK(packedCount(buf, 1) == 2);
+
+	// Out of roster indexes are ignored
+	CHECK(!EBS_Tally_vote(MAX_SCAN_RES, ETX_VOTE_FIRST));
+
+	// A new question starts from nothing
+	EBS_Tally_reset(4);
+	len = EBS_Tally_pack(buf);
+	CHECK(buf[2] == 4);
+	CHECK(BUILD_UINT16(buf[3], buf[4]) == 0);
+	CHECK(BUILD_UINT16(buf[5], buf[6]) == 0);
+	CHECK(buf[7] == 0 && len == 8);
+
+	printf("%s\n", errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Host benchmark of the app timer wheel, drv/board_timer.c built against
+ * the Clock stand-in. Arms thousands of one-shot timers, then reports
+ * the cost of start, restart and stop per call and of process per
+ * wakeup, and checks that every armed timer fires once, on time, and
+ * that stopped ones never fire.
+ *
+ * Start and stop are O(1), so their cost must not grow with the number
+ * of timers armed. Process walks one slot per tick, its cost grows with
+ * timers per slot (timers / BOARD_TIMER_NUM_SLOTS).
+ *
+ *     make -C tools/host_test bench
+ *     tools/host_test/build/timer_bench [max timers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include "board_timer.h"
+
+// Longest timeout armed, in ms
+#define BENCH_MAX_TIMEOUT		30000
+
+// Start and stop at the largest count may cost this much more than at
+// the smallest before the O(1) check fails, leaves room for cache misses
+#define BENCH_O1_SLACK			8.0
+
+typedef struct {
+	double startNs;		// per Board_Timer_start
+	double restartNs;	// per Board_Timer_restart of an armed timer
+	double stopNs;		// per Board_Timer_stop
+	double processNs;	// per Board_Timer_process
+	double firedNs;		// process time per timer fired
+	unsigned errors;
+} BenchResult_t;
+
+static boardTimer_t *timers;
+static uint32_t *timeoutMs;
+static uint32_t *startTick;
+static uint32_t *firedAt;
+static uint16_t *firedCount;
+static uint32_t *order;
+
+static uint32_t nowTicks;
+static uint32_t firedTotal;
+static int woke;
+
+static double nsNow(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void benchWake(void) {
+	woke = 1;
+}
+
+static void benchFire(UArg arg) {
+	firedAt[arg] = nowTicks;
+	firedCount[arg]++;
+	firedTotal++;
+}
+
+static void shuffle(uint32_t n) {
+	uint32_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		order[i] = i;
+	}
+	for (i = n - 1; i > 0; i--)
+	{
+		uint32_t j = rand() % (i + 1);
+		uint32_t t = order[i];
+
+		order[i] = order[j];
+		order[j] = t;
+	}
+}
+
+static uint32_t randTimeout(void) {
+	return BOARD_TIMER_TICK_MS + rand() % BENCH_MAX_TIMEOUT;
+}
+
+static BenchResult_t bench(uint32_t n) {
+	uint32_t tickStep = BOARD_TIMER_TICK_MS * 1000 / Clock_tickPeriod;
+	uint32_t msTicks = 1000 / Clock_tickPeriod;
+	uint32_t stopped = n / 2;
+	uint32_t remaining;
+	uint32_t calls = 0;
+	uint32_t fired = 0;
+	double t0, processNs = 0;
+	BenchResult_t res;
+	uint32_t i;
+
+	memset(&res, 0, sizeof(res));
+	memset(firedCount, 0, n * sizeof(firedCount[0]));
+	firedTotal = 0;
+
+	nowTicks = 0;
+	HostClock_set(nowTicks);
+	Board_Timer_init(benchWake);
+
+	for (i = 0; i < n; i++)
+	{
+		Board_Timer_construct(&timers[i], benchFire, randTimeout(), 0, i);
+	}
+
+	// Arm every timer, random order so the slots fill unevenly
+	shuffle(n);
+	t0 = nsNow();
+	for (i = 0; i < n; i++)
+	{
+		Board_Timer_start(&timers[order[i]]);
+	}
+	res.startNs = (nsNow() - t0) / n;
+
+	// Move every armed timer to a new timeout
+	shuffle(n);
+	for (i = 0; i < n; i++)
+	{
+		timeoutMs[i] = randTimeout();
+		startTick[i] = nowTicks;
+	}
+	t0 = nsNow();
+	for (i = 0; i < n; i++)
+	{
+		Board_Timer_restart(&timers[order[i]], timeoutMs[order[i]]);
+	}
+	res.restartNs = (nsNow() - t0) / n;
+
+	// Stop a random half, order[0 .. stopped - 1]
+	shuffle(n);
+	t0 = nsNow();
+	for (i = 0; i < stopped; i++)
+	{
+		Board_Timer_stop(&timers[order[i]]);
+	}
+	res.stopNs = (nsNow() - t0) / stopped;
+
+	// Step the clock one wheel tick at a time until the rest fired
+	remaining = n - stopped;
+	while (fired < remaining
+			&& nowTicks < (BENCH_MAX_TIMEOUT + 1000) * msTicks)
+	{
+		nowTicks += tickStep;
+		HostClock_set(nowTicks);
+		HostClock_run();
+		if (woke)
+		{
+			woke = 0;
+			t0 = nsNow();
+			Board_Timer_process();
+			processNs += nsNow() - t0;
+			calls++;
+		}
+		fired = firedTotal;
+	}
+	res.processNs = calls ? processNs / calls : 0;
+	res.firedNs = fired ? processNs / fired : 0;
+
+	// Stopped timers stay quiet, the others fire once within a tick
+	for (i = 0; i < n; i++)
+	{
+		uint32_t idx = order[i];
+
+		if (i < stopped)
+		{
+			if (firedCount[idx] != 0)
+			{
+				res.errors++;
+			}
+		} else if (firedCount[idx] != 1)
+		{
+			res.errors++;
+		} else
+		{
+			uint32_t due = startTick[idx] + timeoutMs[idx] * msTicks;
+
+			if ((int32_t) (firedAt[idx] - due) < 0
+					|| firedAt[idx] - due > 2 * tickStep)
+			{
+				res.errors++;
+			}
+		}
+	}
+
+	return res;
+}
+
+int main(int argc, char **argv) {
+	uint32_t maxTimers = (argc > 1) ? (uint32_t) strtoul(argv[1], NULL, 0)
+			: 8192;
+	uint32_t counts[8];
+	BenchResult_t res[8];
+	unsigned numCounts = 0;
+	unsigned errors = 0;
+	double startRatio, stopRatio;
+	uint32_t n;
+	unsigned i;
+
+	if (maxTimers < 256)
+	{
+		maxTimers = 256;
+	}
+	for (n = 256; n < maxTimers && numCounts < 7; n *= 4)
+	{
+		counts[numCounts++] = n;
+	}
+	counts[numCounts++] = maxTimers;
+
+	timers = calloc(maxTimers, sizeof(*timers));
+	timeoutMs = calloc(maxTimers, sizeof(*timeoutMs));
+	startTick = calloc(maxTimers, sizeof(*startTick));
+	firedAt = calloc(maxTimers, sizeof(*firedAt));
+	firedCount = calloc(maxTimers, sizeof(*firedCount));
+	order = calloc(maxTimers, sizeof(*order));
+	if (!timers || !timeoutMs || !startTick || !firedAt || !firedCount
+			|| !order)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 2;
+	}
+
+	srand(1);
+	printf("%d ms ticks, %d slots, timeouts up to %d ms\n",
+			BOARD_TIMER_TICK_MS, BOARD_TIMER_NUM_SLOTS, BENCH_MAX_TIMEOUT);
+	printf("%8s %10s %10s %10s %12s %12s %7s\n", "timers", "start ns",
+			"restart ns", "stop ns", "process ns", "per fire ns", "errors");
+	for (i = 0; i < numCounts; i++)
+	{
+		res[i] = bench(counts[i]);
+		errors += res[i].errors;
+		printf("%8u %10.1f %10.1f %10.1f %12.1f %12.1f %7u\n", counts[i],
+				res[i].startNs, res[i].restartNs, res[i].stopNs,
+				res[i].processNs, res[i].firedNs, res[i].errors);
+	}
+
+	startRatio = res[numCounts - 1].startNs / res[0].startNs;
+	stopRatio = res[numCounts - 1].stopNs / res[0].stopNs;
+	printf("start x%.2f, stop x%.2f from %u to %u timers\n", startRatio,
+			stopRatio, counts[0], counts[numCounts - 1]);
+
+	if (errors)
+	{
+		printf("FAIL: %u timers fired wrong\n", errors);
+		return 1;
+	}
+	if (startRatio > BENCH_O1_SLACK || stopRatio > BENCH_O1_SLACK)
+	{
+		printf("FAIL: start or stop cost grows with the timers armed\n");
+		return 1;
+	}
+
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,287 @@
+/*
+ * Host harness of the vote uplink, src/evrs_bs_uplink.c and the timer
+ * wheel built for Linux. Plays the base station end of the UART on a
+ * pty: frames go out through a TX ring of BOARD_DISPLAY_TX_RING bytes
+ * drained at the UART baud rate, and EBS_CMD_ACK frames from the host
+ * are fed to EBS_Uplink_ack. Votes are pushed as fast as the uplink
+ * takes them, a refused vote is offered again later as a Tx would.
+ * Vote i carries i as its cast time so the host can check the order.
+ *
+ *     uplink_host <pty> <votes> [baud] [timeout s]
+ *
+ * Exits 0 once every vote is acknowledged, printing the counters.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include "board_display.h"
+#include "board_timer.h"
+#include "evrs_bs_cmd.h"
+#include "evrs_bs_uplink.h"
+
+// Longest drain burst, keeps a stall from saving up line time
+#define HOST_DRAIN_BURST		64
+
+static int ptyFd = -1;
+
+// Simulated UART TX ring, as in drv/board_display.c
+static uint8_t txRing[BOARD_DISPLAY_TX_RING];
+static uint16_t txHead = 0;
+static uint16_t txTail = 0;
+static uint32_t txDrops = 0;
+
+// Host frame parser, same framing as Board_Display_Frame
+static enum { RX_SOF, RX_TYPE, RX_LEN, RX_DATA, RX_CHECK } rxState = RX_SOF;
+static uint8_t rxType, rxLen, rxIdx, rxCheck;
+static uint8_t rxBuf[BOARD_DISPLAY_FRAME_MAX];
+
+static int woke = 0;
+
+static uint64_t usNow(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void hostWake(void) {
+	woke = 1;
+}
+
+static void txCopy(const uint8_t *pData, uint16_t len) {
+	while (len--)
+	{
+		txRing[txHead] = *pData++;
+		txHead = (txHead + 1) & (BOARD_DISPLAY_TX_RING - 1);
+	}
+}
+
+uint16_t Board_Display_TxFree(void) {
+	return (BOARD_DISPLAY_TX_RING - 1)
+			- ((txHead - txTail) & (BOARD_DISPLAY_TX_RING - 1));
+}
+
+void Board_Display_Frame(uint8_t type, const uint8_t *pData, uint8_t len) {
+	uint8_t hdr[3];
+	uint8_t check = type ^ len;
+	uint8_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		check ^= pData[i];
+	}
+
+	if (Board_Display_TxFree() < sizeof(hdr) + len + 1)
+	{
+		txDrops++;
+		return;
+	}
+
+	hdr[0] = BOARD_DISPLAY_FRAME_SOF;
+	hdr[1] = type;
+	hdr[2] = len;
+	txCopy(hdr, sizeof(hdr));
+	txCopy(pData, len);
+	txCopy(&check, 1);
+}
+
+// Send what the line carried since the last call, nothing while the
+// host stalls and the pty is full
+static void txDrain(uint32_t *pAllowance) {
+	while (*pAllowance > 0 && txTail != txHead)
+	{
+		uint16_t len = (txHead > txTail) ? txHead - txTail
+				: BOARD_DISPLAY_TX_RING - txTail;
+		ssize_t n;
+
+		if (len > *pAllowance)
+		{
+			len = *pAllowance;
+		}
+		n = write(ptyFd, &txRing[txTail], len);
+		if (n <= 0)
+		{
+			return;
+		}
+		txTail = (txTail + n) & (BOARD_DISPLAY_TX_RING - 1);
+		*pAllowance -= n;
+	}
+}
+
+static void rxFrame(uint8_t type, const uint8_t *pData, uint8_t len) {
+	if (type == EBS_CMD_ACK && len == 3)
+	{
+		EBS_Uplink_ack(BUILD_UINT16(pData[0], pData[1]), pData[2]);
+	}
+}
+
+static void rxParse(uint8_t byte) {
+	switch (rxState)
+	{
+		case RX_SOF:
+			if (byte == BOARD_DISPLAY_FRAME_SOF)
+			{
+				rxState = RX_TYPE;
+			}
+			break;
+
+		case RX_TYPE:
+			rxType = byte;
+			rxCheck = byte;
+			rxState = RX_LEN;
+			break;
+
+		case RX_LEN:
+			rxLen = byte;
+			rxCheck ^= byte;
+			rxIdx = 0;
+			rxState = (rxLen > BOARD_DISPLAY_FRAME_MAX) ? RX_SOF
+					: (rxLen ? RX_DATA : RX_CHECK);
+			break;
+
+		case RX_DATA:
+			rxBuf[rxIdx++] = byte;
+			rxCheck ^= byte;
+			if (rxIdx == rxLen)
+			{
+				rxState = RX_CHECK;
+			}
+			break;
+
+		case RX_CHECK:
+			if (byte == rxCheck)
+			{
+				rxFrame(rxType, rxBuf, rxLen);
+			}
+			rxState = RX_SOF;
+			break;
+	}
+}
+
+static void makeVote(uint32_t i, EbsVoteRec_t *pRec) {
+	pRec->txDevID[0] = (uint8_t) i;
+	pRec->txDevID[1] = 0x00;
+	pRec->txDevID[2] = 0x00;
+	pRec->txDevID[3] = ETX_DEVID_PREFIX;
+	pRec->dataVer = (uint8_t) (i >> 8);
+	pRec->vote = (uint8_t) (i % 5);
+	pRec->voteSeq = (uint16_t) (i >> 8);
+	pRec->epoch = 1;
+	pRec->castMs = i;
+	pRec->battMv = 3000;
+}
+
+int main(int argc, char **argv) {
+	uint32_t votes, baud, timeoutS;
+	uint32_t next = 0;
+	uint32_t allowance = 0;
+	uint64_t start, last, now;
+	EbsUplinkStats_t stats;
+	struct termios tio;
+
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: %s <pty> <votes> [baud] [timeout s]\n",
+				argv[0]);
+		return 2;
+	}
+	votes = strtoul(argv[2], NULL, 0);
+	baud = (argc > 3) ? strtoul(argv[3], NULL, 0) : 115200;
+	timeoutS = (argc > 4) ? strtoul(argv[4], NULL, 0) : 120;
+
+	ptyFd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (ptyFd < 0 || tcgetattr(ptyFd, &tio) != 0)
+	{
+		perror(argv[1]);
+		return 2;
+	}
+	cfmakeraw(&tio);
+	tcsetattr(ptyFd, TCSANOW, &tio);
+
+	start = last = usNow();
+	HostClock_set(0);
+	Board_Timer_init(hostWake);
+	EBS_Uplink_init();
+
+	for (;;)
+	{
+		struct pollfd pfd = { ptyFd, POLLIN, 0 };
+		uint8_t buf[256];
+		ssize_t n;
+
+		now = usNow();
+		HostClock_set((uint32_t) ((now - start) / Clock_tickPeriod));
+		HostClock_run();
+		if (woke)
+		{
+			woke = 0;
+			Board_Timer_process();
+		}
+
+		while ((n = read(ptyFd, buf, sizeof(buf))) > 0)
+		{
+			ssize_t i;
+
+			for (i = 0; i < n; i++)
+			{
+				rxParse(buf[i]);
+			}
+		}
+
+		// Offer votes until the uplink refuses one
+		while (next < votes)
+		{
+			EbsVoteRec_t rec;
+
+			makeVote(next, &rec);
+			if (!EBS_Uplink_push(&rec))
+			{
+				break;
+			}
+			next++;
+		}
+
+		allowance += (uint32_t) ((now - last) * baud / 10 / 1000000);
+		if (allowance > HOST_DRAIN_BURST)
+		{
+			allowance = HOST_DRAIN_BURST;
+		}
+		if ((now - last) * baud / 10 / 1000000 > 0)
+		{
+			last = now;
+		}
+		txDrain(&allowance);
+
+		EBS_Uplink_getStats(&stats);
+		if (stats.acked >= votes)
+		{
+			break;
+		}
+		if (now - start > (uint64_t) timeoutS * 1000000)
+		{
+			fprintf(stderr, "timeout, %u of %u acked\n",
+					(unsigned) stats.acked, (unsigned) votes);
+			break;
+		}
+
+		poll(&pfd, 1, 1);
+	}
+
+	printf("pushed %u refused %u sent %u resent %u acked %u drops %u"
+			" ms %u\n", (unsigned) stats.pushed, (unsigned) stats.refused,
+			(unsigned) stats.sent, (unsigned) stats.resent,
+			(unsigned) stats.acked, (unsigned) txDrops,
+			(unsigned) ((usNow() - start) / 1000));
+
+	close(ptyFd);
+	return (stats.acked >= votes) ? 0 : 1;
+}
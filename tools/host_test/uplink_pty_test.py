@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Uplink test over a pty: build/uplink_host plays the base station,
+this script plays the host (the Pi) on the other end.
+
+The host takes EBS_FRAME_VOTE frames in sequence order only, grants a
+fixed credit and acknowledges the next sequence it expects, as the Pi
+does. Two runs are made:
+
+    clean   no faults, throughput must reach a share of the line rate
+    lossy   vote and ACK frames dropped at random and reads stalled now
+            and then, every vote must still arrive once, in order
+
+    uplink_pty_test.py build/uplink_host [--votes N] [--seed S]
+"""
+
+import argparse
+import os
+import pty
+import random
+import select
+import subprocess
+import sys
+import time
+import tty
+
+FRAME_SOF = 0xA5
+FRAME_MAX = 250
+FRAME_VOTE = 0x17
+CMD_ACK = 0x49
+
+VOTE_REC_LEN = 15           # EBS_VOTE_REC_LEN
+VOTE_TIME_OFF = 9            # cast time in the packed record
+FRAME_HDR_LEN = 3
+FRAME_MAX_REC = 8           # EBS_UPLINK_FRAME_MAX_REC
+
+BAUD = 115200
+HOST_CREDIT = 16
+ACK_PERIOD = 0.05
+
+
+def line_rate():
+    """Votes per second the UART carries in full frames."""
+    frame = 4 + FRAME_HDR_LEN + FRAME_MAX_REC * VOTE_REC_LEN
+    return BAUD / 10 / frame * FRAME_MAX_REC
+
+
+def frame(ftype, payload):
+    check = ftype ^ len(payload)
+    for b in payload:
+        check ^= b
+    return bytes([FRAME_SOF, ftype, len(payload)]) + bytes(payload) \
+        + bytes([check])
+
+
+class FrameParser:
+    """Same framing as Board_Display_Frame, bad frames are skipped."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(bytes([FRAME_SOF]))
+            if start < 0:
+                self.buf.clear()
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 3:
+                return frames
+            ftype, flen = self.buf[1], self.buf[2]
+            if flen > FRAME_MAX:
+                del self.buf[:1]
+                continue
+            if len(self.buf) < flen + 4:
+                return frames
+            payload = bytes(self.buf[3:3 + flen])
+            check = ftype ^ flen
+            for b in payload:
+                check ^= b
+            if check == self.buf[3 + flen]:
+                frames.append((ftype, payload))
+                del self.buf[:flen + 4]
+            else:
+                del self.buf[:1]
+
+
+class Host:
+    def __init__(self, fd, rng, drop, ack_drop, stall_every, stall_len):
+        self.fd = fd
+        self.rng = rng
+        self.drop = drop
+        self.ack_drop = ack_drop
+        self.stall_every = stall_every
+        self.stall_len = stall_len
+        self.parser = FrameParser()
+        self.expected = 0
+        self.delivered = []
+        self.stats = dict(frames=0, dropped=0, dups=0, gaps=0, stalls=0,
+                          acks_dropped=0)
+
+    def ack(self):
+        if self.rng.random() < self.ack_drop:
+            self.stats['acks_dropped'] += 1
+            return
+        seq = self.expected & 0xFFFF
+        os.write(self.fd, frame(CMD_ACK, [seq & 0xFF, seq >> 8,
+                                          HOST_CREDIT]))
+
+    def take(self, payload):
+        seq = payload[0] | payload[1] << 8
+        count = payload[2]
+        for k in range(count):
+            rec = payload[FRAME_HDR_LEN + k * VOTE_REC_LEN:
+                          FRAME_HDR_LEN + (k + 1) * VOTE_REC_LEN]
+            diff = (seq + k - self.expected) & 0xFFFF
+            if diff == 0:
+                off = VOTE_TIME_OFF
+                self.delivered.append(int.from_bytes(rec[off:off + 4],
+                                                     'little'))
+                self.expected += 1
+            elif diff >= 0x8000:
+                self.stats['dups'] += 1
+            else:
+                self.stats['gaps'] += 1
+                break
+
+    def run(self, votes, proc, timeout):
+        start = time.monotonic()
+        last_ack = 0.0
+        next_stall = start + self.stall_every if self.stall_every else None
+        self.ack()
+        while len(self.delivered) < votes and proc.poll() is None:
+            now = time.monotonic()
+            if now - start > timeout:
+                break
+            if next_stall and now >= next_stall:
+                # Stop reading, the pty and the base station ring fill up
+                self.stats['stalls'] += 1
+                time.sleep(self.rng.uniform(*self.stall_len))
+                next_stall = time.monotonic() + self.rng.uniform(
+                    0.5, 1.5) * self.stall_every
+                continue
+            ready, _, _ = select.select([self.fd], [], [], 0.01)
+            if ready:
+                for ftype, payload in self.parser.feed(os.read(self.fd,
+                                                               4096)):
+                    if ftype != FRAME_VOTE:
+                        continue
+                    self.stats['frames'] += 1
+                    if self.rng.random() < self.drop:
+                        self.stats['dropped'] += 1
+                        continue
+                    self.take(payload)
+                    self.ack()
+                    last_ack = now
+            if now - last_ack >= ACK_PERIOD:
+                self.ack()
+                last_ack = now
+        # Let the base station see the last acknowledgement
+        end = time.monotonic()
+        while proc.poll() is None and time.monotonic() - end < 2:
+            self.ack()
+            time.sleep(ACK_PERIOD)
+        return end - start
+
+
+def run(harness, name, votes, seed, drop=0.0, ack_drop=0.0,
+        stall_every=0.0, stall_len=(0.0, 0.0), min_share=0.0,
+        timeout=120):
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    proc = subprocess.Popen([harness, os.ttyname(slave), str(votes),
+                             str(BAUD), str(timeout)],
+                            stdout=subprocess.PIPE, text=True)
+    host = Host(master, random.Random(seed), drop, ack_drop, stall_every,
+                stall_len)
+    try:
+        elapsed = host.run(votes, proc, timeout)
+        out, _ = proc.communicate(timeout=10)
+    finally:
+        if proc.poll() is None:
+            proc.kill()
+        os.close(master)
+        os.close(slave)
+
+    rate = len(host.delivered) / elapsed if elapsed else 0
+    share = rate / line_rate()
+    print('%s: %d votes in %.2f s, %.0f votes/s, %.0f%% of line rate'
+          % (name, len(host.delivered), elapsed, rate, share * 100))
+    print('  host: %s' % ', '.join('%s %d' % kv
+                                   for kv in host.stats.items()))
+    print('  base station: %s' % out.strip())
+
+    errors = []
+    if host.delivered != list(range(votes)):
+        missing = votes - len(set(host.delivered))
+        errors.append('votes not delivered exactly once in order, '
+                      '%d missing' % missing)
+    if proc.returncode != 0:
+        errors.append('base station exited %s' % proc.returncode)
+    if share < min_share:
+        errors.append('throughput under %.0f%% of line rate'
+                      % (min_share * 100))
+    for e in errors:
+        print('  FAIL: %s' % e)
+    return not errors
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('harness', help='uplink_host binary')
+    ap.add_argument('--votes', type=int, default=2000)
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    ok = run(args.harness, 'clean', args.votes, args.seed,
+             min_share=0.6)
+    ok &= run(args.harness, 'lossy', args.votes, args.seed,
+              drop=0.03, ack_drop=0.1, stall_every=2.0,
+              stall_len=(0.2, 0.8), min_share=0.1)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())